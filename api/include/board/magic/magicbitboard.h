@@ -1,6 +1,7 @@
 #pragma once
 
 #include <stdint.h>
+#include <stddef.h>
 #include <array>
 #include "board/magic/magicentry.h"
 namespace coredump
@@ -85,32 +86,155 @@ namespace coredump
         0x0203000000000000ULL, 0x0507000000000000ULL, 0x0A0E000000000000ULL, 0x141C000000000000ULL,
         0x2838000000000000ULL, 0x5070000000000000ULL, 0xA0E0000000000000ULL, 0x40C0000000000000ULL};
 
-    // Initialize magic lookup tables for efficient move generation
-    extern std::array<MagicEntry, 64> rookTable;   // Stores pre-calculated rook move patterns
-    extern std::array<MagicEntry, 64> bishopTable; // Stores pre-calculated bishop move patterns
+    // Entries of the shared slider attack table: 2^(relevant bits) per square, summed over the board
+    constexpr size_t ROOK_ATTACK_ENTRIES = 102400;
+    constexpr size_t BISHOP_ATTACK_ENTRIES = 5248;
 
-    // **MAGIC BITBOARD INITIALIZATION**
-    void initializeMagicBitboards(); // Sets up magic move lookup tables
+    // Magic lookup tables, generated at compile time into read-only data (nothing to initialise)
+    // Every entry points into one contiguous, cache-aligned attack array (rooks first, then bishops)
+    extern const std::array<MagicEntry, 64> rookTable;   // Rook move patterns
+    extern const std::array<MagicEntry, 64> bishopTable; // Bishop move patterns
+
+    // Squares strictly between two squares sharing a rank, file or diagonal (0 if they don't)
+    // Used for check-blocking masks and pin detection
+    extern const std::array<std::array<uint64_t, 64>, 64> betweenTable;
+    // Whole edge-to-edge line through two aligned squares, both included (0 if they don't share one)
+    // A pinned piece may only move along lineTable[kingSquare][pinnedSquare]
+    extern const std::array<std::array<uint64_t, 64>, 64> lineTable;
+
+    // Slow ray-walking versions of the slider lookups, used to build the tables above at compile time
 
     // Generates a mask of potential blocking squares for a rook on a given square
     // Excludes edge squares since they don't affect sliding piece movement calculations
-    uint64_t generateRookMask(int square);
+    constexpr uint64_t generateRookMask(int square)
+    {
+        uint64_t mask = 0ULL;
+        int rank = square / 8; // Get rank (0-7) from square number
+        int file = square % 8; // Get file (0-7) from square number
+
+        // Generate rays in all 4 directions (excluding edges)
+        // North ray
+        for (int r = rank + 1; r < 7; r++)
+            mask |= (1ULL << (r * 8 + file));
+        // South ray
+        for (int r = rank - 1; r > 0; r--)
+            mask |= (1ULL << (r * 8 + file));
+        // East ray
+        for (int f = file + 1; f < 7; f++)
+            mask |= (1ULL << (rank * 8 + f));
+        // West ray
+        for (int f = file - 1; f > 0; f--)
+            mask |= (1ULL << (rank * 8 + f));
+
+        return mask;
+    }
 
     // Generates a mask of potential blocking squares for a bishop on a given square
     // Similar to rook mask but for diagonal movements
-    uint64_t generateBishopMask(int square);
+    constexpr uint64_t generateBishopMask(int square)
+    {
+        uint64_t mask = 0ULL;
+        int rank = square / 8;
+        int file = square % 8;
+
+        // Generate rays in all 4 diagonal directions (excluding edges)
+        // Northeast ray
+        for (int r = rank + 1, f = file + 1; r < 7 && f < 7; r++, f++)
+            mask |= (1ULL << (r * 8 + f));
+        // Southeast ray
+        for (int r = rank + 1, f = file - 1; r < 7 && f > 0; r++, f--)
+            mask |= (1ULL << (r * 8 + f));
+        // Northwest ray
+        for (int r = rank - 1, f = file + 1; r > 0 && f < 7; r--, f++)
+            mask |= (1ULL << (r * 8 + f));
+        // Southwest ray
+        for (int r = rank - 1, f = file - 1; r > 0 && f > 0; r--, f--)
+            mask |= (1ULL << (r * 8 + f));
+
+        return mask;
+    }
 
     // Generates all possible rook attacks for a given square and blocker configuration
-    // Parameters:
-    //   square: The square the bishop is on (0-63)
-    //   blockers: Bitboard representing all blocking pieces
-    // Returns: Bitboard with all possible rook moves/attacks
-    uint64_t generateRookAttacks(int square, uint64_t blockers);
+    constexpr uint64_t generateRookAttacks(int square, uint64_t blockers)
+    {
+        uint64_t attacks = 0ULL;
+        int rank = square / 8;
+        int file = square % 8;
+
+        // Generate attacks in all 4 directions (stopping at blockers)
+        // North ray
+        for (int r = rank + 1; r < 8; r++)
+        {
+            attacks |= (1ULL << (r * 8 + file));
+            if (blockers & (1ULL << (r * 8 + file)))
+                break;
+        }
+        // South ray
+        for (int r = rank - 1; r >= 0; r--)
+        {
+            attacks |= (1ULL << (r * 8 + file));
+            if (blockers & (1ULL << (r * 8 + file)))
+                break;
+        }
+        // East ray
+        for (int f = file + 1; f < 8; f++)
+        {
+            attacks |= (1ULL << (rank * 8 + f));
+            if (blockers & (1ULL << (rank * 8 + f)))
+                break;
+        }
+        // West ray
+        for (int f = file - 1; f >= 0; f--)
+        {
+            attacks |= (1ULL << (rank * 8 + f));
+            if (blockers & (1ULL << (rank * 8 + f)))
+                break;
+        }
+
+        return attacks;
+    }
 
     // Generates all possible bishop attacks from a given square with blocker configuration
     // Parameters:
     //   square: The square the bishop is on (0-63)
     //   blockers: Bitboard representing all blocking pieces
     // Returns: Bitboard with all possible bishop moves/attacks
-    uint64_t generateBishopAttacks(int square, uint64_t blockers);
+    constexpr uint64_t generateBishopAttacks(int square, uint64_t blockers)
+    {
+        uint64_t attacks = 0ULL;
+        int rank = square / 8;
+        int file = square % 8;
+
+        // Generate attacks in all 4 diagonal directions (stopping at blockers)
+        // Northeast ray
+        for (int r = rank + 1, f = file + 1; r < 8 && f < 8; r++, f++)
+        {
+            attacks |= (1ULL << (r * 8 + f));
+            if (blockers & (1ULL << (r * 8 + f)))
+                break; // Stop if blocker found
+        }
+        // Southeast ray
+        for (int r = rank + 1, f = file - 1; r < 8 && f >= 0; r++, f--)
+        {
+            attacks |= (1ULL << (r * 8 + f));
+            if (blockers & (1ULL << (r * 8 + f)))
+                break; // Stop if blocker found
+        }
+        // Northwest ray
+        for (int r = rank - 1, f = file + 1; r >= 0 && f < 8; r--, f++)
+        {
+            attacks |= (1ULL << (r * 8 + f));
+            if (blockers & (1ULL << (r * 8 + f)))
+                break; // Stop if blocker found
+        }
+        // Southwest ray
+        for (int r = rank - 1, f = file - 1; r >= 0 && f >= 0; r--, f--)
+        {
+            attacks |= (1ULL << (r * 8 + f));
+            if (blockers & (1ULL << (r * 8 + f)))
+                break; // Stop if blocker found
+        }
+
+        return attacks;
+    }
 }
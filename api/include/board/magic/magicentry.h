@@ -1,14 +1,26 @@
 #pragma once
 
 #include <stdint.h>
-#include <vector>
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
 namespace coredump
 {
     struct MagicEntry
     {
-        uint64_t mask;                 // Mask for relevant occupancy bits
-        uint64_t magic;                // Magic number for this square
-        int shift;                     // Right shift amount
-        std::vector<uint64_t> attacks; // Pre-calculated attack patterns
+        uint64_t mask;           // Mask for relevant occupancy bits
+        uint64_t magic;          // Magic number for this square (unused by the PEXT path)
+        const uint64_t *attacks; // This square's slice of the shared slider attack table
+        unsigned shift;          // Right shift amount (unused by the PEXT path)
+
+        // Offset of an occupancy within attacks. BMI2 builds extract the masked bits directly with PEXT
+        inline uint64_t index(uint64_t occupied) const
+        {
+#if defined(__BMI2__)
+            return _pext_u64(occupied, mask);
+#else
+            return ((occupied & mask) * magic) >> shift;
+#endif
+        }
     };
 }
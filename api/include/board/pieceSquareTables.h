@@ -0,0 +1,160 @@
+#pragma once
+
+#include <array>
+#include "color.h"
+
+namespace coredump
+{
+    // Material values, piece-square tables and phase weights. Shared by the evaluation and by Position,
+    // which keeps their sums up to date on every move (see PieceScores)
+
+    // Material values for each piece type (in centipawns)
+    constexpr int PAWN_VALUE = 100;   // Base value for pawns
+    constexpr int KNIGHT_VALUE = 300; // Base value for knights
+    constexpr int BISHOP_VALUE = 330; // Base value for bishops
+    constexpr int ROOK_VALUE = 500;   // Base value for rooks
+    constexpr int QUEEN_VALUE = 900;  // Base value for queens
+    constexpr int KING_VALUE = 20000; // Base value for king (very high to prioritize king safety)
+
+    // Piece-Square Tables (PST) for positional evaluation
+    // Higher values indicate better squares for that piece
+    // Tables are oriented from White's perspective (a1 is bottom-left)
+
+    // Pawn PST - Encourages pawns to:
+    // - Advance towards promotion
+    // - Control the center
+    // - Maintain pawn structure
+    constexpr std::array<int, 64> PAWN_PST = {
+        0, 0, 0, 0, 0, 0, 0, 0,         // 8th rank
+        50, 50, 50, 50, 50, 50, 50, 50, // 7th rank (promotion potential)
+        10, 10, 20, 30, 30, 20, 10, 10, // 6th rank
+        5, 5, 10, 25, 25, 10, 5, 5,     // 5th rank
+        0, 0, 0, 20, 20, 0, 0, 0,       // 4th rank
+        5, -5, -10, 0, 0, -10, -5, 5,   // 3rd rank
+        5, 10, 10, -20, -20, 10, 10, 5, // 2nd rank
+        0, 0, 0, 0, 0, 0, 0, 0          // 1st rank
+    };
+
+    // Knight PST - Encourages knights to:
+    // - Occupy central squares
+    // - Avoid edge squares
+    constexpr std::array<int, 64> KNIGHT_PST = {
+        -50, -40, -30, -30, -30, -30, -40, -50, // Edge penalties
+        -40, -20, 0, 0, 0, 0, -20, -40,
+        -30, 0, 10, 15, 15, 10, 0, -30,
+        -30, 5, 15, 20, 20, 15, 5, -30, // Center bonuses
+        -30, 0, 15, 20, 20, 15, 0, -30,
+        -30, 5, 10, 15, 15, 10, 5, -30,
+        -40, -20, 0, 5, 5, 0, -20, -40,
+        -50, -40, -30, -30, -30, -30, -40, -50};
+
+    // Bishop PST - Encourages bishops to:
+    // - Control long diagonals
+    // - Support center control
+    // - Stay active
+    constexpr std::array<int, 64> BISHOP_PST = {
+        -20, -10, -10, -10, -10, -10, -10, -20,
+        -10, 0, 0, 0, 0, 0, 0, -10,
+        -10, 0, 5, 10, 10, 5, 0, -10,
+        -10, 5, 5, 10, 10, 5, 5, -10,
+        -10, 0, 10, 10, 10, 10, 0, -10,
+        -10, 10, 10, 10, 10, 10, 10, -10,
+        -10, 5, 0, 0, 0, 0, 5, -10,
+        -20, -10, -10, -10, -10, -10, -10, -20};
+
+    // Rook PST - Encourages rooks to:
+    // - Control open files
+    // - Move to 7th rank
+    // - Support from behind pawns
+    constexpr std::array<int, 64> ROOK_PST = {
+        0, 0, 0, 0, 0, 0, 0, 0,
+        5, 10, 10, 10, 10, 10, 10, 5, // 7th rank bonus
+        -5, 0, 0, 0, 0, 0, 0, -5,
+        -5, 0, 0, 0, 0, 0, 0, -5,
+        -5, 0, 0, 0, 0, 0, 0, -5,
+        -5, 0, 0, 0, 0, 0, 0, -5,
+        -5, 0, 0, 0, 0, 0, 0, -5,
+        0, 0, 0, 5, 5, 0, 0, 0 // Slight bonus for central files
+    };
+
+    // Queen PST - Encourages queens to:
+    // - Stay protected early game
+    // - Control center when active
+    // - Avoid early development
+    constexpr std::array<int, 64> QUEEN_PST = {
+        -20, -10, -10, -5, -5, -10, -10, -20,
+        -10, 0, 0, 0, 0, 0, 0, -10,
+        -10, 0, 5, 5, 5, 5, 0, -10,
+        -5, 0, 5, 5, 5, 5, 0, -5,
+        0, 0, 5, 5, 5, 5, 0, -5,
+        -10, 5, 5, 5, 5, 5, 0, -10,
+        -10, 0, 5, 0, 0, 0, 0, -10,
+        -20, -10, -10, -5, -5, -10, -10, -20};
+
+    // King PST - Encourages kings to:
+    // - Stay protected behind pawn shield
+    // - Castle early
+    // - Avoid center in middlegame
+    constexpr std::array<int, 64> KING_PST = {
+        -30, -40, -40, -50, -50, -40, -40, -30,
+        -30, -40, -40, -50, -50, -40, -40, -30,
+        -30, -40, -40, -50, -50, -40, -40, -30,
+        -30, -40, -40, -50, -50, -40, -40, -30,
+        -20, -30, -30, -40, -40, -30, -30, -20,
+        -10, -20, -20, -20, -20, -20, -20, -10,
+        20, 20, 0, 0, 0, 0, 20, 20,  // Castled position bonus
+        20, 30, 10, 0, 0, 10, 30, 20 // Corner protection bonus
+    };
+
+    // Endgame King PST - Encourages the king to:
+    // - Walk to the centre once the heavy pieces are gone
+    // - Stay off the edges and corners, where it gets mated
+    constexpr std::array<int, 64> KING_ENDGAME_PST = {
+        -50, -40, -30, -20, -20, -30, -40, -50,
+        -30, -20, -10, 0, 0, -10, -20, -30,
+        -30, -10, 20, 30, 30, 20, -10, -30,
+        -30, -10, 30, 40, 40, 30, -10, -30,
+        -30, -10, 30, 40, 40, 30, -10, -30,
+        -30, -10, 20, 30, 30, 20, -10, -30,
+        -30, -30, 0, 0, 0, 0, -30, -30,
+        -50, -30, -30, -30, -30, -30, -30, -50};
+
+    // Mirroring function for black's perspective (flips board vertically)
+    constexpr int mirror(int square)
+    {
+        return square ^ 56;
+    }
+
+    // PST entry for a piece of color C on square. The tables are written rank 8 first, so white mirrors
+    template <Color C>
+    constexpr int pstIndex(int square)
+    {
+        return (C == Color::WHITE) ? mirror(square) : square;
+    }
+
+    // Game phase weight per piece type, indexed by PieceType. The starting position sums to MAX_PHASE
+    constexpr int PHASE_WEIGHT[6] = {0, 1, 1, 2, 4, 0};
+    constexpr int MAX_PHASE = 24;
+
+    // Material plus PST for each zobrist piece index and square, white positive and black negative
+    // Position adds or subtracts one entry per piece update; only the king has a separate endgame table
+    constexpr std::array<std::array<int, 64>, 12> buildPieceSquareScores(bool endgame)
+    {
+        const int material[6] = {PAWN_VALUE, KNIGHT_VALUE, BISHOP_VALUE, ROOK_VALUE, QUEEN_VALUE, 0};
+        const std::array<int, 64> *pst[6] = {&PAWN_PST, &KNIGHT_PST, &BISHOP_PST, &ROOK_PST, &QUEEN_PST,
+                                             endgame ? &KING_ENDGAME_PST : &KING_PST};
+        std::array<std::array<int, 64>, 12> table{};
+        for (int type = 0; type < 6; type++)
+        {
+            for (int square = 0; square < 64; square++)
+            {
+                table[type][square] = material[type] + (*pst[type])[pstIndex<Color::WHITE>(square)];
+                table[type + 6][square] = -(material[type] + (*pst[type])[pstIndex<Color::BLACK>(square)]);
+            }
+        }
+        return table;
+    }
+
+    inline constexpr std::array<std::array<int, 64>, 12> MIDGAME_PSQ = buildPieceSquareScores(false);
+    inline constexpr std::array<std::array<int, 64>, 12> ENDGAME_PSQ = buildPieceSquareScores(true);
+}
@@ -1,54 +1,173 @@
 #pragma once
 
 #include <stdint.h>
+#include <cstring>
 #include <string>
 #include <iostream>
 #include <sstream>
+#include <stdexcept>
 #include "board/bitboard.h"
 #include "extraHeuristics/zobrist.h"
+#include "move/packedMove.h"
 
 namespace coredump
 {
-    inline void updateBitboard(uint64_t &bitboard, uint64_t &fromBB, uint64_t &toBB)
+    // Mailbox value of an empty square; occupied squares hold the zobrist piece index
+    constexpr int8_t NO_PIECE = -1;
+
+    // Zobrist piece index (0-5 white pawn..king, 6-11 black pawn..king)
+    constexpr inline int makePieceIndex(Color color, PieceType type)
     {
-        bitboard &= ~fromBB; // Remove piece from its original square
-        bitboard |= toBB;    // Place piece in the new square
+        return (color == Color::WHITE ? 0 : 6) + static_cast<int>(type);
     }
 
-    inline void handleCapture(uint64_t &bitboard, uint64_t &captureBB)
+    // Rook squares for a castling move, from the king's destination
+    inline void castlingRookSquares(int kingTo, int &rookFrom, int &rookTo)
     {
-        bitboard &= ~captureBB; // Remove captured piece from its square
+        bool kingside = (kingTo % 8) == 6;
+        int rankBase = kingTo - (kingTo % 8);
+        rookFrom = rankBase + (kingside ? 7 : 0);
+        rookTo = rankBase + (kingside ? 5 : 3);
     }
 
+    // Attack information about the current board, indexed by Color. Filled in lazily, one group at a time,
+    // by the accessors in movegen.h (checkers, pinnedPieces, checkSquares, discoverers)
+    struct AttackInfo
+    {
+        enum Group : uint8_t
+        {
+            CHECKS = 1,        // checkers, pinned
+            CHECK_SQUARES = 4  // checkSquares, discoverers
+        };
+
+        uint64_t checkers[2];        // Enemy pieces attacking this colour's king
+        uint64_t pinned[2];          // This colour's pieces pinned to its own king
+        uint64_t checkSquares[2][6]; // Squares from which this colour's pieces, per type, would attack the enemy king
+        uint64_t discoverers[2];     // This colour's pieces standing between one of its sliders and the enemy king
+        uint8_t valid;               // Group bits, shifted left by the colour index
+
+        static uint8_t bit(Group group, Color color) { return static_cast<uint8_t>(group << static_cast<int>(color)); }
+    };
+
+    // Running evaluation sums, kept up to date by every piece update so the static evaluation never rescans the board
+    struct PieceScores
+    {
+        int midgame; // Material + midgame PST, white minus black
+        int endgame; // Material + endgame PST, white minus black
+        int phase;   // Sum of PHASE_WEIGHT over the pieces on the board (can exceed MAX_PHASE after promotions)
+
+        bool operator==(const PieceScores &other) const
+        {
+            return midgame == other.midgame && endgame == other.endgame && phase == other.phase;
+        }
+    };
+
+    // Irreversible state saved by makeMove, so undoMove can restore it exactly
+    // The search keeps one per ply; nothing here can be recomputed from the board after the move
+    struct StateInfo
+    {
+        uint64_t hash;           // Zobrist key before the move
+        int enPassantSquare;     // En passant square before the move (-1 if none)
+        uint8_t castlingRights;  // Castling rights before the move
+        PieceType capturedPiece; // Piece taken by the move (NONE if quiet)
+    };
+
     struct Position
     {
-        // Public bitboard fields
-        uint64_t whitePawns, whiteKnights, whiteBishops, whiteRooks, whiteQueens, whiteKing;
-        uint64_t blackPawns, blackKnights, blackBishops, blackRooks, blackQueens, blackKing;
+        // Board representation, kept in sync by every piece update
+        uint64_t byType[6];  // Both colors, indexed by PieceType
+        uint64_t byColor[2]; // All pieces of one color, indexed by Color
+        uint64_t occupied;   // byColor[WHITE] | byColor[BLACK]
+        int8_t board[64];    // Zobrist piece index on each square, NO_PIECE if empty
         uint8_t castlingRights;
         int enPassantSquare;
+        Color sideToMove;
+        uint64_t hash; // Zobrist key, kept up to date by makeMove/undoMove
+        PieceScores scores; // Material, PST and phase, kept up to date with the board
+
+        // Per-node attack cache. Every board change drops it and copies start without it;
+        // a null move keeps it, since none of it depends on the side to move
+        mutable AttackInfo attackInfo;
 
         // Starting board state constructor
         Position();
-        // Copy constructor
-        Position(const Position &other);
+        // Copy constructor (board state only, the attack cache is rebuilt on demand)
+        Position(const Position &other) : occupied(other.occupied), castlingRights(other.castlingRights),
+                                          enPassantSquare(other.enPassantSquare), sideToMove(other.sideToMove), hash(other.hash),
+                                          scores(other.scores)
+        {
+            std::memcpy(byType, other.byType, sizeof(byType));
+            std::memcpy(byColor, other.byColor, sizeof(byColor));
+            std::memcpy(board, other.board, sizeof(board));
+            attackInfo.valid = 0;
+        }
+        Position &operator=(const Position &other) = default;
+        // Same board state (pieces, rights, en passant square, side to move, key and scores); the attack cache is ignored
+        bool operator==(const Position &other) const;
         // Construct from position + move
         Position(const Position &other, const Move &move);
+        // Construct from a FEN string (move counters are accepted but not kept)
+        // Throws std::invalid_argument if the FEN is malformed
+        explicit Position(const std::string &fen);
+
+        // Composite bitboards
+        uint64_t getWhitePieces() const { return byColor[0]; }
+        uint64_t getBlackPieces() const { return byColor[1]; }
+        uint64_t getOccupiedSquares() const { return occupied; }
+        uint64_t getEmptySquares() const { return ~occupied; }
 
-        // Getters for on the fly composite bitboards
-        uint64_t getWhitePieces() const;
-        uint64_t getBlackPieces() const;
-        uint64_t getOccupiedSquares() const;
-        uint64_t getEmptySquares() const;
+        uint64_t pieces(Color color) const { return byColor[static_cast<int>(color)]; }
+        uint64_t pieces(PieceType type) const { return byType[static_cast<int>(type)]; }
+        uint64_t pieces(Color color, PieceType type) const { return byType[static_cast<int>(type)] & byColor[static_cast<int>(color)]; }
+        uint64_t pieces(PieceType first, PieceType second) const { return byType[static_cast<int>(first)] | byType[static_cast<int>(second)]; }
+        uint64_t pieces(Color color, PieceType first, PieceType second) const { return pieces(first, second) & byColor[static_cast<int>(color)]; }
+        int kingSquare(Color color) const { return __builtin_ctzll(pieces(color, PieceType::KING)); }
+
+        // Bitboard for a zobrist piece index (0-5 white pawn..king, 6-11 black pawn..king)
+        uint64_t pieceBitboard(int pieceIndex) const { return byType[pieceIndex % 6] & byColor[pieceIndex / 6]; }
+        // Zobrist piece index of the piece of the given color on square, or -1 if there is none
+        int pieceIndexOn(int square, Color color) const
+        {
+            int pieceIndex = board[square];
+            return (pieceIndex != NO_PIECE && (pieceIndex >= 6) == (color == Color::BLACK)) ? pieceIndex : -1;
+        }
+        // Same, for a piece of either color
+        int pieceIndexOn(int square) const { return board[square]; }
+        // Type of the piece on square, or NONE if it is empty
+        PieceType pieceTypeOn(int square) const
+        {
+            return (board[square] == NO_PIECE) ? PieceType::NONE : static_cast<PieceType>(board[square] % 6);
+        }
+
+        // Move details that PackedMove leaves out, read off the board before the move is made
+        PieceType movedPieceType(PackedMove move) const { return pieceTypeOn(move.from()); }
+        PieceType capturedPieceType(PackedMove move) const { return move.isEnPassant() ? PieceType::PAWN : pieceTypeOn(move.to()); }
+        bool isCapture(PackedMove move) const { return move.isEnPassant() || board[move.to()] != NO_PIECE; }
+
+        // Conversions between the search move and the full Move used by the bindings and console
+        Move toMove(PackedMove move) const;
+        PackedMove toPackedMove(const Move &move) const;
 
         // Function prototypes
-        uint64_t computeHash() const;
+        uint64_t computeHash() const;      // Full rescan, used to seed and verify the incremental key
+        PieceScores computeScores() const; // Full rescan, used to verify the incremental scores
         std::string displayPosition();
         std::string getFen(Color toMove, int halfmoveClock, int fullmoveNumber, std::string castlingRights, std::string enPassantTarget);
         char getSquareChar(int square);
 
-        // Move modifiers
+        // Move modifiers. The mover is whoever owns the piece on the from square
+        void makeMove(PackedMove move, StateInfo &state);
+        void undoMove(PackedMove move, const StateInfo &state);
+        // Move-level wrappers for the bindings; undoMove expects a Move produced by toMove
         void makeMove(const Move &move);
         void undoMove(const Move &move);
+        void makeNullMove(); // Passes the turn (null move pruning)
+
+    private:
+        // Board updates: bitboards, occupancy and mailbox together. The key is the caller's job
+        void clearBoard();
+        void putPiece(int pieceIndex, int square);
+        void removePiece(int square);
+        void movePiece(int from, int to);
     };
 }
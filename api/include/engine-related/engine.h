@@ -17,10 +17,15 @@
 #include <bitset>
 #include <unordered_map>
 #include "engine-related/search.h"
-#include "board/threadSafePosition.h"
+#include "engine-related/threadPool.h"
 
 namespace coredump
 {
+    // One-time engine setup: the transposition table and the thread pool
+    void initEngine();
+
     Move findBestMove(const Position &position, Color color, int maxDepth, double timeLimitSeconds, bool debug, std::ostringstream &debugStream);
+    // Searches within limits (clock, fixed time, nodes, depth) and returns the best move of the last completed iteration
+    Move findBestMove(const Position &position, Color color, const SearchLimits &limits, bool debug, std::ostringstream &debugStream);
     Move findRandomMove(const Position &position, Color color);
 }
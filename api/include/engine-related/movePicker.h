@@ -0,0 +1,67 @@
+#pragma once
+
+#include <stddef.h>
+#include "board/position.h"
+#include "move/movegen.h"
+#include "engine-related/evaluation.h"
+#include "engine-related/searchThread.h"
+
+namespace coredump
+{
+    // Hands out legal moves one at a time, best first, in stages:
+    //   TT move, good captures (MVV-LVA, passing SEE), killers, quiets by history, bad captures (by SEE)
+    // Each group is generated and scored only when its stage is reached, then picked by partial selection,
+    // so a cutoff on the TT move or a good capture never generates or scores the quiets
+    // A side in check in quiescence gets its own path: TT move, then the evasions, captures before quiets
+    class MovePicker
+    {
+    public:
+        // Main search: every stage, with the killers and history of the thread running the search
+        MovePicker(const Position &pos, Color color, PackedMove ttMove, int ply, const SearchThread &thread);
+        // Quiescence: TT move (if it is a capture) and good captures only, then the quiet checks if asked for
+        MovePicker(const Position &pos, Color color, PackedMove ttMove, bool quietChecks = false);
+        // Quiescence in check: TT move, then every evasion, captures by MVV-LVA before quiets by history
+        MovePicker(const Position &pos, Color color, PackedMove ttMove, const SearchThread &thread);
+
+        // Next move to search, or a none move (isNone()) when every stage is exhausted
+        PackedMove nextMove();
+
+    private:
+        enum class Stage
+        {
+            TT_MOVE,
+            GENERATE_CAPTURES,
+            GOOD_CAPTURES,
+            KILLERS,
+            GENERATE_QUIETS,
+            QUIETS,
+            BAD_CAPTURES,
+            GENERATE_QUIET_CHECKS,
+            QUIET_CHECKS,
+            GENERATE_EVASIONS,
+            EVASIONS,
+            DONE
+        };
+
+        const Position &pos;
+        const SearchThread *thread; // Null in quiescence out of check, which never reaches the quiet stages
+        Color color;
+        PackedMove ttMove;
+        PackedMove killers[2];
+        bool capturesOnly;
+        bool quietChecks; // Quiescence only: follow the good captures with the quiet checks
+        bool evasions;    // In check: the evasion stages replace all the others
+        Stage stage;
+
+        MoveList captures, quiets, badCaptures;
+        bool capturesGenerated, quietsGenerated;
+        int captureScores[MAX_MOVES];
+        int quietScores[MAX_MOVES];
+        size_t current;     // Next unpicked index in the list the current stage works through
+        size_t killerIndex; // Next killer slot to try
+
+        void generateCaptureList();
+        void generateQuietList();
+        bool isPreviouslyPicked(PackedMove move) const;
+    };
+}
@@ -1,14 +1,14 @@
 #pragma once
 
-#include <vector>
 #include <algorithm>
 #include <climits>
+#include "move/moveList.h"
 #include "extraHeuristics/transposition/transposition.h"
 #include "engine-related/evaluation.h"
-#include "extraHeuristics/historyHeuristic.h"
-#include "extraHeuristics/killerMoves.h"
+#include "engine-related/searchThread.h"
 
 namespace coredump
 {
-    int sortMoves(std::vector<Move> &moves, const Position &pos, int ply, Color color);
+    // thread supplies killers and history; without one, moves are ordered by the TT move and MVV-LVA only
+    int sortMoves(MoveList &moves, const Position &pos, int ply, Color color, const SearchThread *thread = nullptr);
 }
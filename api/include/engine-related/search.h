@@ -9,13 +9,41 @@
 #include "move/movegen.h"
 #include "engine-related/evaluation.h"
 #include "engine-related/prioritization.h"
-#include "extraHeuristics/killerMoves.h"
+#include "engine-related/movePicker.h"
+#include "engine-related/searchThread.h"
+#include "engine-related/timeManager.h"
 
 namespace coredump
 {
-    int minimax(std::chrono::high_resolution_clock::time_point startTime, double timeLimit,
-        const Position &pos, int depth, int alpha, int beta, Color maximizingColor, Color currentColor, int ply);
+    // Score bounds. Being mated n plies from the root scores -(MATE_SCORE - n), so shorter mates score higher
+    constexpr int INFINITE_SCORE = KING_VALUE * 2;
+    constexpr int MATE_SCORE = KING_VALUE;
+    constexpr int MATE_BOUND = MATE_SCORE - MAX_PLY; // Anything beyond this is a forced mate
+
+    // Principal variation search: the first move gets the full window, the rest a null-window scout
+    // that is re-searched only if it beats alpha. Returns a fail-soft score from color's point of view
+    // Killers, history, the PV and node counts go to thread, which only the calling thread may touch
+    // When timer stops the search, returns 0 and the caller must discard the result (check searchStopped)
     int negamax(const Position &pos, int depth, int alpha, int beta, Color color, int ply,
-                std::chrono::high_resolution_clock::time_point startTime, double timeLimit, std::atomic<uint64_t> &nodeCount, std::atomic<uint64_t> &leafNodeCount);
-    int quiescenceSearch(const Position &pos, int alpha, int beta, Color color, int ply);
+                TimeManager &timer, SearchThread &thread);
+
+    // Quiescence depths, as stored in the transposition table (always below any main search depth)
+    constexpr int QS_DEPTH_CHECKS = 0;     // First quiescence ply: quiet checks are searched too
+    constexpr int QS_DEPTH_NO_CHECKS = -1; // Deeper: captures and promotions only
+    // Delta pruning margin: a capture must be able to come within this of alpha to be searched
+    constexpr int QS_DELTA_MARGIN = 200;
+
+    // Searches captures (and quiet checks at QS_DEPTH_CHECKS) until the position is quiet; every evasion when in check
+    int quiescenceSearch(const Position &pos, int alpha, int beta, Color color, int ply, int depth,
+                         TimeManager &timer, SearchThread &thread);
+
+    // Searches the root moves inside (alpha, beta), PVS style, and leaves the best line in thread.stack[0].pv
+    // Moves the best move to the front of rootMoves so the next iteration searches it first
+    int searchRoot(const Position &pos, MoveList &rootMoves, int depth, int alpha, int beta, Color color,
+                   TimeManager &timer, SearchThread &thread);
+
+    // One iterative deepening step: a root search in an aspiration window around previousScore,
+    // widened on each fail low or fail high until the score lands inside it
+    int aspirationSearch(const Position &pos, MoveList &rootMoves, int depth, int previousScore, Color color,
+                         TimeManager &timer, SearchThread &thread);
 }
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include "move/packedMove.h"
+#include "color.h"
+
+namespace coredump
+{
+    // Deepest ply the search will reach; nodes beyond it return their static evaluation
+    constexpr int MAX_PLY = 100;
+
+    // Principal variation, collected on the way back up the tree: each PV node keeps its best move
+    // followed by the line its child returned
+    struct PVLine
+    {
+        PackedMove moves[MAX_PLY];
+        int length = 0;
+
+        void update(PackedMove move, const PVLine &child)
+        {
+            moves[0] = move;
+            length = 1;
+            for (int i = 0; i < child.length && length < MAX_PLY; i++)
+                moves[length++] = child.moves[i];
+        }
+    };
+
+    // What the search knows about one ply of the line it is currently on
+    struct SearchStackEntry
+    {
+        int staticEval;          // Evaluation of the node before searching it (unset while in check)
+        PackedMove currentMove;  // Move being searched from this node, none for a null move
+        PackedMove excludedMove; // Move this node must skip (left none by the normal search)
+        PVLine pv;               // Best line found from this node
+    };
+
+    // Everything one search thread writes while it searches. Each thread owns one, so the
+    // move ordering heuristics need neither locks nor atomics
+    // Aligned to a cache line so neighbouring contexts never share one
+    struct alignas(64) SearchThread
+    {
+        int id = 0; // 0 is the main thread, helpers are numbered from 1
+
+        PackedMove killers[MAX_PLY][2]; // Two quiet moves per ply that caused a beta cutoff
+        int history[2][64][64];         // Cutoff counts for quiet moves, by color, from, to
+        SearchStackEntry stack[MAX_PLY + 1];
+
+        // The only fields other threads read (for the node counts in search output)
+        std::atomic<uint64_t> nodeCount{0};
+        std::atomic<uint64_t> leafNodeCount{0};
+
+        SearchThread() { clear(); }
+
+        // Empties the heuristics and counters before a new search
+        void clear();
+
+        void storeKillerMove(PackedMove move, int ply)
+        {
+            if (0 <= ply && ply < MAX_PLY && !(killers[ply][0] == move))
+            {
+                killers[ply][1] = killers[ply][0]; // Shift second-best
+                killers[ply][0] = move;            // Store best killer move
+            }
+        }
+
+        void storeHistoryHeuristic(PackedMove move, int depth, Color color)
+        {
+            if (0 <= depth && depth < MAX_PLY)
+                history[(color == Color::WHITE) ? 0 : 1][move.from()][move.to()] += depth * depth;
+        }
+
+        int historyScore(PackedMove move, Color color) const
+        {
+            return history[(color == Color::WHITE) ? 0 : 1][move.from()][move.to()];
+        }
+    };
+}
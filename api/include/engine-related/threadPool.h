@@ -0,0 +1,106 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace coredump
+{
+    // Snapshot of pool activity since creation (or the last resetStats)
+    struct ThreadPoolStats
+    {
+        int threads;             // Worker count
+        uint64_t tasksSubmitted; // Tasks handed to the pool
+        uint64_t tasksExecuted;  // Tasks finished
+        uint64_t tasksStolen;    // Tasks a worker took from another worker's queue
+        double busySeconds;      // Summed time workers spent running tasks
+        double wallSeconds;      // Time since the stats were reset
+        double utilisation;      // busySeconds / (wallSeconds * threads), 0-1
+    };
+
+    // Persistent worker pool with one task deque per worker and work stealing
+    // Owners pop from the back of their own deque (LIFO, cache warm), idle workers steal from the front of others (FIFO)
+    class ThreadPool
+    {
+    public:
+        explicit ThreadPool(int threadCount);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool &) = delete;
+        ThreadPool &operator=(const ThreadPool &) = delete;
+
+        // Number of worker threads
+        int size() const { return static_cast<int>(workers.size()); }
+
+        // Queues a task and returns a future for its result
+        // From inside a worker the task goes to that worker's own deque, otherwise queues are filled round-robin
+        template <typename F>
+        std::future<typename std::invoke_result<F>::type> submit(F &&task)
+        {
+            using Result = typename std::invoke_result<F>::type;
+            auto packaged = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task));
+            std::future<Result> future = packaged->get_future();
+            enqueue([packaged]()
+                    { (*packaged)(); });
+            return future;
+        }
+
+        // Waits for a future, running queued tasks on the calling thread meanwhile
+        // Safe to call from inside a worker without starving the pool
+        template <typename T>
+        T wait(std::future<T> &future)
+        {
+            while (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            {
+                if (!runPendingTask())
+                    std::this_thread::yield();
+            }
+            return future.get();
+        }
+
+        ThreadPoolStats getStats() const;
+        void resetStats();
+
+    private:
+        struct Worker
+        {
+            std::deque<std::function<void()>> tasks;
+            std::mutex mutex;
+            std::thread thread;
+            std::atomic<uint64_t> busyNanoseconds{0};
+        };
+
+        std::vector<std::unique_ptr<Worker>> workers;
+        std::mutex sleepMutex;
+        std::condition_variable wakeUp;
+        std::atomic<int> pendingTasks{0};
+        std::atomic<bool> stopping{false};
+        std::atomic<size_t> nextQueue{0};
+
+        std::atomic<uint64_t> tasksSubmitted{0};
+        std::atomic<uint64_t> tasksExecuted{0};
+        std::atomic<uint64_t> tasksStolen{0};
+        std::chrono::steady_clock::time_point statsStart;
+
+        void enqueue(std::function<void()> task);
+        bool popTask(int workerIndex, std::function<void()> &task);
+        bool runPendingTask();
+        void runTask(int workerIndex, std::function<void()> &task);
+        void workerLoop(int workerIndex);
+    };
+
+    // Engine-wide pool. Created by initEngine (or lazily on first use) with one worker per hardware thread
+    ThreadPool &getThreadPool();
+
+    // Recreates the engine-wide pool with the given worker count. Must not be called while a search is running
+    void setThreadCount(int threadCount);
+}
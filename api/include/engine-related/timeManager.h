@@ -0,0 +1,59 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+
+namespace coredump
+{
+    // Raised when a limit is hit (or the main thread finishes) so every search thread unwinds
+    extern std::atomic<bool> searchStopped;
+
+    // What the search may spend on one move. Zero means no limit of that kind
+    struct SearchLimits
+    {
+        int depth = 0;           // Deepest iteration to run
+        uint64_t nodes = 0;      // Nodes the main thread may search
+        double moveTime = 0;     // Fixed seconds for this move
+        double remaining = 0;    // Seconds left on our clock
+        double increment = 0;    // Seconds added to our clock per move
+        int movesToGo = 0;       // Moves until the next time control, 0 for sudden death
+    };
+
+    // Turns SearchLimits into two budgets and enforces them
+    //   soft: checked between iterations; past it, no new iteration is started
+    //   hard: checked while searching; past it, searchStopped is raised and the iteration is thrown away
+    // Only the main search thread polls, and only every POLL_INTERVAL nodes, so the clock stays off the hot path
+    class TimeManager
+    {
+    public:
+        static constexpr uint64_t POLL_INTERVAL = 1024;
+
+        // Starts the clock and derives the budgets. Also lowers searchStopped
+        void start(const SearchLimits &limits);
+
+        // Called by the main thread once per node; reads the clock only every POLL_INTERVAL nodes
+        void poll(uint64_t nodes)
+        {
+            if ((nodes & (POLL_INTERVAL - 1)) == 0)
+                checkLimits(nodes);
+        }
+
+        // After a finished iteration: whether another one is worth starting
+        bool shouldStop(int completedDepth) const;
+
+        double elapsed() const;
+        double softLimit() const { return softSeconds; }
+        double hardLimit() const { return hardSeconds; }
+        int maxDepth() const { return depthLimit; }
+
+    private:
+        std::chrono::steady_clock::time_point startTime;
+        double softSeconds = 0; // 0 when the search has no time limit
+        double hardSeconds = 0;
+        uint64_t nodeLimit = 0;
+        int depthLimit = 0;
+
+        void checkLimits(uint64_t nodes);
+    };
+}
@@ -1,14 +1,33 @@
 #pragma once
 
-#include "move/move.h"
+#include <stdint.h>
+#include <atomic>
+#include "move/packedMove.h"
+#include "extraHeuristics/transposition/TTflag.h"
 namespace coredump
 {
+    // Decoded view of a table slot, filled in by probeTT
     struct TTEntry
     {
         uint64_t zobristKey; // Unique position hash
         int depth;           // Depth of search
         int score;           // Stored evaluation score
-        Move bestMove;       // Best move found
-        int flag;            // Exact, Upper bound, Lower bound
+        PackedMove bestMove; // Best move found (none if the node failed low)
+        TTFlag flag;         // Exact, Upper bound, Lower bound
+    };
+
+    // A single stored entry. The key word holds (zobrist ^ data) so that a torn write from
+    // another thread fails verification instead of returning mismatched data (lockless hashing)
+    struct TTSlot
+    {
+        std::atomic<uint64_t> key;
+        std::atomic<uint64_t> data;
+    };
+
+    // Four slots share one 64 byte cache line, so a probe costs a single cache miss
+    constexpr int TT_BUCKET_SLOTS = 4;
+    struct alignas(64) TTBucket
+    {
+        TTSlot slots[TT_BUCKET_SLOTS];
     };
 }
@@ -1,15 +1,33 @@
 #pragma once
 
 #include <stdint.h>
-#include <unordered_map>
+#include <stddef.h>
 #include "extraHeuristics/transposition/TTentry.h"
 #include "extraHeuristics/transposition/TTflag.h"
 
 namespace coredump
 {
-    extern std::unordered_map<uint64_t, TTEntry> transpositionTable;
+    // Hash size used until resizeTT is called with something else
+    constexpr size_t DEFAULT_TT_SIZE_MB = 64;
 
-    void storeTT(uint64_t hash, int depth, int score, Move bestMove, TTFlag flag);
+    // (Re)allocates the table to the largest power-of-two bucket count fitting in megabytes, and clears it
+    // Must not be called while a search is running
+    void resizeTT(size_t megabytes);
 
-    TTEntry *probeTT(uint64_t zobristKey, int depth, int alpha, int beta);
+    // Wipes every entry without reallocating
+    void clearTT();
+
+    // Advances the table age. Called once per search so stale entries lose replacement priority
+    void newSearchTT();
+
+    // Pulls the bucket for zobristKey into cache. Call it as early as the key is known, ahead of probeTT
+    void prefetchTT(uint64_t zobristKey);
+
+    void storeTT(uint64_t hash, int depth, int score, PackedMove bestMove, TTFlag flag);
+
+    // Returns true and fills entry if the position is in the table
+    bool probeTT(uint64_t zobristKey, TTEntry &entry);
+
+    // Approximate table occupancy in permille, sampled from the first 1000 buckets
+    int hashfullTT();
 }
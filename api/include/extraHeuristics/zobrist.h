@@ -2,16 +2,13 @@
 
 #include <stdint.h>
 #include <array>
-#include <random>
 
 namespace coredump
 {
     // Zobrist hashing for position hashing
-    extern std::array<std::array<uint64_t, 64>, 12> zobristTable;
-    extern uint64_t zobristEnPassant[8];
-    extern uint64_t zobristCastling[16]; // 16 combinations of castling rights
-    extern uint64_t zobristTurn;
-
-    // Initializes Zobrist hashing table
-    void initZobrist();
+    // Generated at compile time into read-only data, so they are valid before any code runs
+    extern const std::array<std::array<uint64_t, 64>, 12> zobristTable;
+    extern const std::array<uint64_t, 8> zobristEnPassant;
+    extern const std::array<uint64_t, 16> zobristCastling; // 16 combinations of castling rights
+    extern const uint64_t zobristTurn;
 }
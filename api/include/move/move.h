@@ -7,6 +7,7 @@
 #include "pieceType.h"
 #include "color.h"
 #include "castlingType.h"
+#include "move/packedMove.h"
 
 namespace coredump
 {
@@ -24,24 +25,17 @@ namespace coredump
         bool isPromotion;         // True if this is a pawn promotion
         PieceType promotionPiece; // Piece type to promote to
 
-        // Movement undoing fields
-        uint64_t capturedPieceBitboard; // Bitboard of captured piece (if any)
-        PieceType capturedPieceType;    // Type of captured piece (if any)
-
-        uint64_t prevWhitePieces, prevBlackPieces; // Board states before move
-        uint64_t prevOccupied;                     // Previous occupied squares
-
-        int prevEnPassantSquare;    // En passant square before the move (-1 if none)
-        int prevKingSquare;         // Stores king's position before the move
-        uint8_t prevCastlingRights; // Bitmask of castling rights before move
+        // Movement undoing fields, filled in by Position::toMove for Position::undoMove(const Move &)
+        // The search itself uses PackedMove and keeps this state in a StateInfo instead
+        PieceType capturedPieceType; // Type of captured piece (if any)
+        int prevEnPassantSquare;     // En passant square before the move (-1 if none)
+        uint8_t prevCastlingRights;  // Bitmask of castling rights before move
 
         // Constructor
         Move(int from, int to, bool capture, PieceType type, Color col, bool castling,
              CastlingType castlingType = CastlingType::NONE, bool promotion = false,
-             PieceType promoPiece = PieceType::NONE, uint64_t capturedBitboard = 0,
-             PieceType capturedType = PieceType::NONE, uint64_t prevWhite = 0,
-             uint64_t prevBlack = 0, uint64_t prevOccupiedSquares = 0,
-             int enPassantSquare = -1, uint8_t castlingRights = 0, int kingSquare = -1);
+             PieceType promoPiece = PieceType::NONE, PieceType capturedType = PieceType::NONE,
+             int enPassantSquare = -1, uint8_t castlingRights = 0);
 
         Move(int from, int to, Color col);
 
@@ -56,4 +50,7 @@ namespace coredump
         static std::string toAlgebraic(int square);
         static int fromAlgebraic(char file, char rank);
     };
+
+    // Coordinate notation for a move ("e2e4", "e7e8q")
+    std::string moveToString(PackedMove move);
 }
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <stddef.h>
+#include <new>
+#include <type_traits>
+#include "move/packedMove.h"
+
+namespace coredump
+{
+    // Upper bound on legal moves in any chess position (the known maximum is 218)
+    constexpr int MAX_MOVES = 256;
+
+    // Fixed-capacity move list with inline storage, so generating moves never touches the heap
+    // Storage is left uninitialised; only the first count() slots hold constructed moves
+    class MoveList
+    {
+    public:
+        MoveList() : moveCount(0) {}
+
+        MoveList(const MoveList &other) : moveCount(0)
+        {
+            for (PackedMove move : other)
+                push_back(move);
+        }
+
+        MoveList &operator=(const MoveList &other)
+        {
+            moveCount = 0;
+            for (PackedMove move : other)
+                push_back(move);
+            return *this;
+        }
+
+        void push_back(PackedMove move) { new (&storage[moveCount++]) PackedMove(move); }
+        void clear() { moveCount = 0; }
+
+        size_t size() const { return moveCount; }
+        bool empty() const { return moveCount == 0; }
+
+        PackedMove &operator[](size_t index) { return data()[index]; }
+        const PackedMove &operator[](size_t index) const { return data()[index]; }
+
+        PackedMove *begin() { return data(); }
+        PackedMove *end() { return data() + moveCount; }
+        const PackedMove *begin() const { return data(); }
+        const PackedMove *end() const { return data() + moveCount; }
+
+    private:
+        static_assert(std::is_trivially_destructible<PackedMove>::value, "MoveList never runs move destructors");
+
+        typename std::aligned_storage<sizeof(PackedMove), alignof(PackedMove)>::type storage[MAX_MOVES];
+        size_t moveCount;
+
+        PackedMove *data() { return std::launder(reinterpret_cast<PackedMove *>(storage)); }
+        const PackedMove *data() const { return std::launder(reinterpret_cast<const PackedMove *>(storage)); }
+    };
+}
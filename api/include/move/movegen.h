@@ -1,8 +1,8 @@
 #pragma once
 
-#include <vector>
 #include <algorithm>
 #include "board/position.h"
+#include "move/moveList.h"
 #include "board/magic/magicbitboard.h"
 
 namespace coredump
@@ -15,45 +15,79 @@ namespace coredump
     // Bitboard constants for specific ranks
     constexpr uint64_t RANK_1 = 0x00000000000000FFULL; // Bottom rank (white's back rank)
     constexpr uint64_t RANK_2 = 0x000000000000FF00ULL; // White pawn starting rank
+    constexpr uint64_t RANK_3 = 0x0000000000FF0000ULL; // White single push from the starting rank
     constexpr uint64_t RANK_4 = 0x00000000FF000000ULL; // White pawn double push target rank
     constexpr uint64_t RANK_5 = 0x000000FF00000000ULL; // Black pawn double push target rank
+    constexpr uint64_t RANK_6 = 0x0000FF0000000000ULL; // Black single push from the starting rank
     constexpr uint64_t RANK_7 = 0x00FF000000000000ULL; // Black pawn starting rank
     constexpr uint64_t RANK_8 = 0xFF00000000000000ULL; // Top rank (black's back rank)
 
-    std::vector<Move> generateMoves(const Position &pos, Color);                      // Generate all legal moves
-    uint64_t getPawnMoves(int square, Color, uint64_t occupied, const Position &pos); // Gets pawn moves
-    uint64_t getCastlingMoves(Color, uint64_t occupied, const Position &pos);         // Gets legal castling moves
-    std::vector<Move> generateCaptures(const Position &pos, Color);                   // Generates all legal captures
+    // Which legal moves generateMoves produces. CAPTURES also holds every promotion and en passant;
+    // QUIETS is everything else (including castling), so the two together are exactly ALL
+    // EVASIONS is ALL for a side in check, without the castling probe
+    // QUIET_CHECKS is the QUIETS that give direct or discovered check, castling excluded
+    enum class GenType
+    {
+        ALL,
+        CAPTURES,
+        QUIETS,
+        EVASIONS,
+        QUIET_CHECKS
+    };
+
+    // Legal moves for Us, appended to moveList. Instantiated for both colours and every GenType
+    template <Color Us, GenType Type>
+    void generateMoves(const Position &pos, MoveList &moveList);
+
+    MoveList generateMoves(const Position &pos, Color, GenType type = GenType::ALL); // Generate legal moves
+    uint64_t attackersTo(int square, uint64_t occupied, const Position &pos); // Pieces of both colors attacking square
     bool isSquareAttacked(int square, Color, const Position &pos);
-    bool wouldLeaveKingInCheck(const Position &pos, const Move &move);
+    // Single-move validation against the bitboards, no generation. Both accept any 16 bit value (a TT or killer move
+    // from another position, a hash collision, user input) and agree exactly with the legal generator's output
+    bool isPseudoLegal(const Position &pos, Color, PackedMove move); // Legal apart from leaving its own king in check
+    bool isLegal(const Position &pos, Color, PackedMove move);       // Exactly the moves generateMoves produces
     bool isInCheck(const Position &pos, Color);
+    bool hasAnyLegalMove(const Position &pos, Color); // Stops at the first legal move; for mate and stalemate tests
     int checkEndgameConditions(const Position &pos, Color);
 
+    // Slider lookups are a single load; the compile-time build guarantees every index is in range
     inline uint64_t getRookMoves(int square, uint64_t occupied)
     {
-        MagicEntry &entry = rookTable[square];
-        uint64_t blockers = occupied & entry.mask;
-        uint64_t index = ((blockers * entry.magic) >> entry.shift);
-        if (index >= entry.attacks.size())
-        {
-            return 0ULL; // Return empty bitboard if index is out of bounds
-        }
-        return entry.attacks[index];
+        const MagicEntry &entry = rookTable[square];
+        return entry.attacks[entry.index(occupied)];
     }
 
     inline uint64_t getBishopMoves(int square, uint64_t occupied)
     {
-        MagicEntry &entry = bishopTable[square];
-        uint64_t blockers = occupied & entry.mask;
-        uint64_t index = ((blockers * entry.magic) >> entry.shift);
+        const MagicEntry &entry = bishopTable[square];
+        return entry.attacks[entry.index(occupied)];
+    }
 
-        index &= (entry.attacks.size() - 1);
-        // Safety check for array bounds
-        if (index >= entry.attacks.size())
-        {
-            return 0ULL; // Return empty bitboard if index is out of bounds
-        }
-        return entry.attacks[index];
+    // Shifts a bitboard by Delta squares (one of +-8, +-7, +-9), dropping anything that wraps around the board edge
+    template <int Delta>
+    constexpr uint64_t shift(uint64_t bitboard)
+    {
+        static_assert(Delta == 8 || Delta == -8 || Delta == 7 || Delta == -7 || Delta == 9 || Delta == -9, "not a single step");
+        if (Delta == 8)
+            return bitboard << 8;
+        if (Delta == -8)
+            return bitboard >> 8;
+        if (Delta == 9 || Delta == -7) // Eastward: the a-file can only be reached by wrapping
+            return (Delta > 0 ? bitboard << 9 : bitboard >> 7) & ~FILE_A;
+        return (Delta > 0 ? bitboard << 7 : bitboard >> 9) & ~FILE_H;
+    }
+
+    // Squares a pawn of color C on square attacks
+    template <Color C>
+    constexpr uint64_t getPawnAttacks(int square)
+    {
+        const uint64_t pawnBB = 1ULL << square;
+        return (C == Color::WHITE) ? shift<7>(pawnBB) | shift<9>(pawnBB) : shift<-9>(pawnBB) | shift<-7>(pawnBB);
+    }
+
+    inline uint64_t getPawnAttacks(int square, Color color)
+    {
+        return (color == Color::WHITE) ? getPawnAttacks<Color::WHITE>(square) : getPawnAttacks<Color::BLACK>(square);
     }
 
     inline uint64_t getKnightMoves(int square)
@@ -71,4 +105,76 @@ namespace coredump
         // Queen moves are combination of rook and bishop moves
         return getRookMoves(square, occupied) | getBishopMoves(square, occupied);
     }
+
+    // Attacks of a non-pawn piece type, with the type fixed at compile time
+    template <PieceType Type>
+    inline uint64_t pieceAttacks(int square, uint64_t occupied)
+    {
+        static_assert(Type != PieceType::PAWN && Type != PieceType::NONE, "pawn attacks depend on colour");
+        switch (Type)
+        {
+        case PieceType::KNIGHT:
+            return getKnightMoves(square);
+        case PieceType::BISHOP:
+            return getBishopMoves(square, occupied);
+        case PieceType::ROOK:
+            return getRookMoves(square, occupied);
+        case PieceType::QUEEN:
+            return getQueenMoves(square, occupied);
+        default:
+            return getKingMoves(square);
+        }
+    }
+
+    // Whether any piece of color Them attacks square, given the occupancy (which may differ from the board)
+    // Cheapest tests first, so most probes end before touching the slider tables
+    template <Color Them>
+    inline bool isAttackedBy(int square, uint64_t occupied, const Position &pos)
+    {
+        constexpr Color Us = (Them == Color::WHITE) ? Color::BLACK : Color::WHITE;
+        return (getPawnAttacks<Us>(square) & pos.pieces(Them, PieceType::PAWN)) ||
+               (getKnightMoves(square) & pos.pieces(Them, PieceType::KNIGHT)) ||
+               (getKingMoves(square) & pos.pieces(Them, PieceType::KING)) ||
+               (getBishopMoves(square, occupied) & pos.pieces(Them, PieceType::BISHOP, PieceType::QUEEN)) ||
+               (getRookMoves(square, occupied) & pos.pieces(Them, PieceType::ROOK, PieceType::QUEEN));
+    }
+
+    // Per-node attack information, computed on first use and cached on the position (see AttackInfo)
+    void computeChecks(const Position &pos, Color color);
+    void computeCheckSquares(const Position &pos, Color color);
+
+    // Enemy pieces giving check to color's king
+    inline uint64_t checkers(const Position &pos, Color color)
+    {
+        if (!(pos.attackInfo.valid & AttackInfo::bit(AttackInfo::CHECKS, color)))
+            computeChecks(pos, color);
+        return pos.attackInfo.checkers[static_cast<int>(color)];
+    }
+
+    // color's pieces pinned to its own king
+    inline uint64_t pinnedPieces(const Position &pos, Color color)
+    {
+        if (!(pos.attackInfo.valid & AttackInfo::bit(AttackInfo::CHECKS, color)))
+            computeChecks(pos, color);
+        return pos.attackInfo.pinned[static_cast<int>(color)];
+    }
+
+    // Squares from which a piece of color and type would attack the enemy king
+    inline uint64_t checkSquares(const Position &pos, Color color, PieceType type)
+    {
+        if (!(pos.attackInfo.valid & AttackInfo::bit(AttackInfo::CHECK_SQUARES, color)))
+            computeCheckSquares(pos, color);
+        return pos.attackInfo.checkSquares[static_cast<int>(color)][static_cast<int>(type)];
+    }
+
+    // color's pieces that give discovered check by leaving their line to the enemy king
+    inline uint64_t discoverers(const Position &pos, Color color)
+    {
+        if (!(pos.attackInfo.valid & AttackInfo::bit(AttackInfo::CHECK_SQUARES, color)))
+            computeCheckSquares(pos, color);
+        return pos.attackInfo.discoverers[static_cast<int>(color)];
+    }
+
+    // Whether a legal move checks the opponent, without making it
+    bool givesCheck(const Position &pos, PackedMove move);
 }
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <stdint.h>
+#include "pieceType.h"
+
+namespace coredump
+{
+    // Special move kinds, stored in the top two bits of a PackedMove
+    enum class MoveFlag : uint8_t
+    {
+        NORMAL,
+        PROMOTION,
+        EN_PASSANT,
+        CASTLING
+    };
+
+    // 16 bit move used by the search, move lists, the transposition table and the killer tables
+    // Layout: from (bits 0-5) | to (bits 6-11) | promotion piece - KNIGHT (bits 12-13) | flag (bits 14-15)
+    // Everything else about a move (piece, capture, colour) is read off the position when needed
+    // The all-zero value (a1 to a1) can never be a real move and doubles as "no move"
+    struct PackedMove
+    {
+        uint16_t data;
+
+        constexpr PackedMove() : data(0) {}
+        constexpr explicit PackedMove(uint16_t raw) : data(raw) {}
+        constexpr PackedMove(int from, int to, MoveFlag flag = MoveFlag::NORMAL, PieceType promotion = PieceType::KNIGHT)
+            : data(static_cast<uint16_t>(from | (to << 6) |
+                                         ((static_cast<int>(promotion) - static_cast<int>(PieceType::KNIGHT)) << 12) |
+                                         (static_cast<int>(flag) << 14))) {}
+
+        constexpr int from() const { return data & 0x3F; }
+        constexpr int to() const { return (data >> 6) & 0x3F; }
+        constexpr MoveFlag flag() const { return static_cast<MoveFlag>(data >> 14); }
+        constexpr PieceType promotionPiece() const { return static_cast<PieceType>(((data >> 12) & 3) + static_cast<int>(PieceType::KNIGHT)); }
+
+        constexpr bool isPromotion() const { return flag() == MoveFlag::PROMOTION; }
+        constexpr bool isEnPassant() const { return flag() == MoveFlag::EN_PASSANT; }
+        constexpr bool isCastling() const { return flag() == MoveFlag::CASTLING; }
+        constexpr bool isNone() const { return data == 0; }
+
+        constexpr bool operator==(PackedMove other) const { return data == other.data; }
+        constexpr bool operator!=(PackedMove other) const { return data != other.data; }
+    };
+
+    static_assert(sizeof(PackedMove) == 2, "PackedMove must stay 16 bits");
+}
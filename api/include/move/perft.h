@@ -0,0 +1,54 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "board/position.h"
+#include "move/movegen.h"
+#include "move/referencePositions.h"
+
+namespace coredump
+{
+    // Node count below one root move
+    struct DivideEntry
+    {
+        std::string move; // Coordinate notation, e.g. "e2e4" or "e7e8q"
+        uint64_t nodes;
+    };
+
+    // Leaf nodes of the legal move tree to the given depth, for the side to move
+    // Leaves are bulk counted (the last ply returns the move count instead of making each move)
+    // hashMegabytes > 0 shares a perft hash of that size between all threads for this call
+    // parallel splits the root moves across the engine thread pool
+    uint64_t perft(const Position &pos, int depth, size_t hashMegabytes = 0, bool parallel = true);
+
+    // Same as perft, broken down by root move
+    std::vector<DivideEntry> divide(const Position &pos, int depth, size_t hashMegabytes = 0, bool parallel = true);
+
+    // Runs every reference position, printing counts, timings and nodes/sec to out
+    // maxDepth 0 uses each position's suiteDepth, otherwise the deepest listed depth up to maxDepth
+    // Returns true if every count matched
+    bool runPerftSuite(std::ostream &out, int maxDepth = 0, size_t hashMegabytes = 0, bool parallel = true);
+
+    // Times the two ways the search can update a position, over every move of every position up to
+    // depth 2 from the reference positions: make/unmake on one board, and copy-make into a fresh one
+    // Also checks the incremental key and scores after every makeMove, and that every undoMove restores the
+    // board exactly. Returns false if any check failed
+    bool runUpdateBenchmark(std::ostream &out, int rounds = 20);
+
+    // Cross-checks the generator's modes against each other in every position up to depth plies from the
+    // reference positions: CAPTURES and QUIETS split ALL exactly, EVASIONS is ALL whenever in check, and
+    // QUIET_CHECKS is the non-castling QUIETS that leave the opponent in check. Also checks givesCheck against
+    // the made move, the cached checkers and pins against a square-by-square recount, and isLegal against the
+    // generated list for all 65536 move values (every generated move must also pass isPseudoLegal), and
+    // hasAnyLegalMove against whether the list is empty
+    // Returns false on any mismatch
+    bool runMoveGenCheck(std::ostream &out, int depth = 2);
+
+    // Compares the rook and bishop table lookups (PEXT or magic index, whichever this build uses) with the slow
+    // ray walk for every subset of every square's blocker mask, with unrelated squares filled in at random
+    // Returns false on any difference
+    bool runSliderCheck(std::ostream &out);
+}
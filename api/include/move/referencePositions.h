@@ -0,0 +1,62 @@
+#pragma once
+
+#include <stdint.h>
+#include <array>
+#include "board/position.h"
+#include "move/movegen.h"
+
+namespace coredump
+{
+    // Standard perft test position with its published node counts
+    struct PerftPosition
+    {
+        const char *name;
+        const char *fen;
+        int suiteDepth;                   // Depth the suite runs by default (a fraction of a second each)
+        std::array<uint64_t, 6> expected; // Node counts for depth 1-6, 0 where not listed
+    };
+
+    // Start position, Kiwipete and positions 3-6 from the chessprogramming wiki
+    inline const std::array<PerftPosition, 6> PERFT_POSITIONS = {{
+        {"Start position", "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 5,
+         {20ULL, 400ULL, 8902ULL, 197281ULL, 4865609ULL, 119060324ULL}},
+        {"Kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 4,
+         {48ULL, 2039ULL, 97862ULL, 4085603ULL, 193690690ULL, 8031647685ULL}},
+        {"Position 3", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 5,
+         {14ULL, 191ULL, 2812ULL, 43238ULL, 674624ULL, 11030083ULL}},
+        {"Position 4", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 4,
+         {6ULL, 264ULL, 9467ULL, 422333ULL, 15833292ULL, 706045033ULL}},
+        {"Position 5", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 4,
+         {44ULL, 1486ULL, 62379ULL, 2103487ULL, 89941194ULL, 0ULL}},
+        {"Position 6", "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", 4,
+         {46ULL, 2079ULL, 89890ULL, 3894594ULL, 164075551ULL, 6923051137ULL}},
+    }};
+
+    // Calls visit(const Position &) on every position up to depth plies from pos, pos itself first
+    // pos is made and unmade in place, so it is back to where it started afterwards
+    template <typename Visit>
+    void visitPositions(Position &pos, int depth, Visit &&visit)
+    {
+        visit(pos);
+        if (depth == 0)
+            return;
+        for (PackedMove move : generateMoves(pos, pos.sideToMove))
+        {
+            StateInfo state;
+            pos.makeMove(move, state);
+            visitPositions(pos, depth - 1, visit);
+            pos.undoMove(move, state);
+        }
+    }
+
+    // Same walk from each of PERFT_POSITIONS in turn: the sample set of the correctness checks and benchmarks
+    template <typename Visit>
+    void visitReferencePositions(int depth, Visit &&visit)
+    {
+        for (const PerftPosition &test : PERFT_POSITIONS)
+        {
+            Position pos(test.fen);
+            visitPositions(pos, depth, visit);
+        }
+    }
+}
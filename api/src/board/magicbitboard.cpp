@@ -1,216 +1,99 @@
 #include "board/magic/magicbitboard.h"
 
+#include <stdexcept>
+
 namespace coredump
 {
-    // Initialize magic lookup tables for efficient move generation
-    std::array<MagicEntry, 64> rookTable = {};   // Stores pre-calculated rook move patterns
-    std::array<MagicEntry, 64> bishopTable = {}; // Stores pre-calculated bishop move patterns
+    // Everything in this file is evaluated by the compiler and lands in read-only data, so startup does no work
+    // and every engine process maps the same pages. A bad magic number is a compile error
 
-    void initializeMagicBitboards()
+    // Fills one square's slice of the attack table, enumerating every subset of the mask (carry-rippler)
+    // Returns the number of entries used, so the next square's slice can start right after it
+    static constexpr size_t fillSlice(uint64_t *attacks, int square, uint64_t mask, uint64_t magic,
+                                      uint64_t (*generateAttacks)(int, uint64_t))
     {
-        // Initialize rook tables
-        for (int square = 0; square < 64; square++)
-        {
-            rookTable[square].mask = generateRookMask(square);
-            rookTable[square].magic = ROOK_MAGICS[square];
-            rookTable[square].shift = 64 - __builtin_popcountll(rookTable[square].mask);
-
-            uint64_t mask = rookTable[square].mask;
-            int variations = 1 << __builtin_popcountll(mask);
-
-            // Pre-allocate with proper size
-            rookTable[square].attacks.clear();
-            rookTable[square].attacks.resize(variations);
-
-            for (int i = 0; i < variations; i++)
-            {
-                uint64_t blockers = 0ULL;
-                int bit = 0;
-                for (int j = 0; j < 64; j++)
-                {
-                    if (mask & (1ULL << j))
-                    {
-                        if (i & (1 << bit))
-                        {
-                            blockers |= (1ULL << j);
-                        }
-                        bit++;
-                    }
-                }
-
-                uint64_t index = ((blockers * rookTable[square].magic) >> rookTable[square].shift);
-                index &= (variations - 1); // Ensure index is within bounds
-                rookTable[square].attacks[index] = generateRookAttacks(square, blockers);
-            }
-        }
-
-        // Similar changes for bishop table initialization
-        for (int square = 0; square < 64; square++)
+        const unsigned shift = 64 - __builtin_popcountll(mask);
+        uint64_t blockers = 0ULL;
+        uint64_t subset = 0;
+        do
         {
-            bishopTable[square].mask = generateBishopMask(square);
-            bishopTable[square].magic = BISHOP_MAGICS[square];
-            bishopTable[square].shift = 64 - __builtin_popcountll(bishopTable[square].mask);
-
-            uint64_t mask = bishopTable[square].mask;
-            int variations = 1 << __builtin_popcountll(mask);
-
-            bishopTable[square].attacks.clear();
-            bishopTable[square].attacks.resize(variations);
-
-            for (int i = 0; i < variations; i++)
-            {
-                uint64_t blockers = 0ULL;
-                int bit = 0;
-                for (int j = 0; j < 64; j++)
-                {
-                    if (mask & (1ULL << j))
-                    {
-                        if (i & (1 << bit))
-                        {
-                            blockers |= (1ULL << j);
-                        }
-                        bit++;
-                    }
-                }
-
-                uint64_t index = ((blockers * bishopTable[square].magic) >> bishopTable[square].shift);
-                index &= (variations - 1); // Ensure index is within bounds
-                bishopTable[square].attacks[index] = generateBishopAttacks(square, blockers);
-            }
-        }
+            uint64_t attackSet = generateAttacks(square, blockers);
+#if defined(__BMI2__)
+            // PEXT has no constexpr form, but the carry-rippler visits subsets in PEXT order: the n-th lives at n
+            (void)magic;
+            (void)shift;
+            uint64_t &slot = attacks[subset++];
+#else
+            (void)subset;
+            uint64_t &slot = attacks[((blockers & mask) * magic) >> shift];
+#endif
+            // Attack sets are never empty, so a filled slot with different contents is a bad magic
+            if (slot && slot != attackSet)
+                throw std::logic_error("Magic number collision");
+            slot = attackSet;
+            blockers = (blockers - mask) & mask;
+        } while (blockers);
+
+        return 1ULL << __builtin_popcountll(mask);
     }
 
-    // Generates a mask of potential blocking squares for a rook on a given square
-    // Excludes edge squares since they don't affect sliding piece movement calculations
-    uint64_t generateRookMask(int square)
+    static constexpr std::array<uint64_t, ROOK_ATTACK_ENTRIES + BISHOP_ATTACK_ENTRIES> buildSliderAttacks()
     {
-        uint64_t mask = 0ULL;
-        int rank = square / 8; // Get rank (0-7) from square number
-        int file = square % 8; // Get file (0-7) from square number
-
-        // Generate rays in all 4 directions (excluding edges)
-        // North ray
-        for (int r = rank + 1; r < 7; r++)
-            mask |= (1ULL << (r * 8 + file));
-        // South ray
-        for (int r = rank - 1; r > 0; r--)
-            mask |= (1ULL << (r * 8 + file));
-        // East ray
-        for (int f = file + 1; f < 7; f++)
-            mask |= (1ULL << (rank * 8 + f));
-        // West ray
-        for (int f = file - 1; f > 0; f--)
-            mask |= (1ULL << (rank * 8 + f));
-
-        return mask;
+        std::array<uint64_t, ROOK_ATTACK_ENTRIES + BISHOP_ATTACK_ENTRIES> table{};
+        size_t offset = 0;
+        for (int square = 0; square < 64; square++)
+            offset += fillSlice(table.data() + offset, square, generateRookMask(square), ROOK_MAGICS[square], generateRookAttacks);
+        // Bishop slices follow the rook ones in the same array
+        for (int square = 0; square < 64; square++)
+            offset += fillSlice(table.data() + offset, square, generateBishopMask(square), BISHOP_MAGICS[square], generateBishopAttacks);
+        return table;
     }
 
-    // Generates a mask of potential blocking squares for a bishop on a given square
-    // Similar to rook mask but for diagonal movements
-    uint64_t generateBishopMask(int square)
-    {
-        uint64_t mask = 0ULL;
-        int rank = square / 8;
-        int file = square % 8;
-
-        // Generate rays in all 4 diagonal directions (excluding edges)
-        // Northeast ray
-        for (int r = rank + 1, f = file + 1; r < 7 && f < 7; r++, f++)
-            mask |= (1ULL << (r * 8 + f));
-        // Southeast ray
-        for (int r = rank + 1, f = file - 1; r < 7 && f > 0; r++, f--)
-            mask |= (1ULL << (r * 8 + f));
-        // Northwest ray
-        for (int r = rank - 1, f = file + 1; r > 0 && f < 7; r--, f++)
-            mask |= (1ULL << (r * 8 + f));
-        // Southwest ray
-        for (int r = rank - 1, f = file - 1; r > 0 && f > 0; r--, f--)
-            mask |= (1ULL << (r * 8 + f));
-
-        return mask;
-    }
+    // Every rook and bishop attack set, sliced per square by the entries below
+    alignas(64) static constexpr std::array<uint64_t, ROOK_ATTACK_ENTRIES + BISHOP_ATTACK_ENTRIES> sliderAttacks = buildSliderAttacks();
 
-    // Generates all possible rook attacks for a given square and blocker configuration
-    uint64_t generateRookAttacks(int square, uint64_t blockers)
+    static constexpr std::array<MagicEntry, 64> buildMagicEntries(bool rook)
     {
-        uint64_t attacks = 0ULL;
-        int rank = square / 8;
-        int file = square % 8;
-
-        // Generate attacks in all 4 directions (stopping at blockers)
-        // North ray
-        for (int r = rank + 1; r < 8; r++)
-        {
-            attacks |= (1ULL << (r * 8 + file));
-            if (blockers & (1ULL << (r * 8 + file)))
-                break;
-        }
-        // South ray
-        for (int r = rank - 1; r >= 0; r--)
-        {
-            attacks |= (1ULL << (r * 8 + file));
-            if (blockers & (1ULL << (r * 8 + file)))
-                break;
-        }
-        // East ray
-        for (int f = file + 1; f < 8; f++)
-        {
-            attacks |= (1ULL << (rank * 8 + f));
-            if (blockers & (1ULL << (rank * 8 + f)))
-                break;
-        }
-        // West ray
-        for (int f = file - 1; f >= 0; f--)
+        std::array<MagicEntry, 64> entries{};
+        size_t offset = rook ? 0 : ROOK_ATTACK_ENTRIES;
+        for (int square = 0; square < 64; square++)
         {
-            attacks |= (1ULL << (rank * 8 + f));
-            if (blockers & (1ULL << (rank * 8 + f)))
-                break;
+            uint64_t mask = rook ? generateRookMask(square) : generateBishopMask(square);
+            entries[square] = {mask, rook ? ROOK_MAGICS[square] : BISHOP_MAGICS[square], sliderAttacks.data() + offset,
+                               static_cast<unsigned>(64 - __builtin_popcountll(mask))};
+            offset += 1ULL << __builtin_popcountll(mask);
         }
-
-        return attacks;
+        return entries;
     }
 
-    // Generates all possible bishop attacks from a given square with blocker configuration
-    // Parameters:
-    //   square: The square the bishop is on (0-63)
-    //   blockers: Bitboard representing all blocking pieces
-    // Returns: Bitboard with all possible bishop moves/attacks
-    uint64_t generateBishopAttacks(int square, uint64_t blockers)
-    {
-        uint64_t attacks = 0ULL;
-        int rank = square / 8;
-        int file = square % 8;
+    constexpr std::array<MagicEntry, 64> rookTable = buildMagicEntries(true);
+    constexpr std::array<MagicEntry, 64> bishopTable = buildMagicEntries(false);
 
-        // Generate attacks in all 4 diagonal directions (stopping at blockers)
-        // Northeast ray
-        for (int r = rank + 1, f = file + 1; r < 8 && f < 8; r++, f++)
-        {
-            attacks |= (1ULL << (r * 8 + f));
-            if (blockers & (1ULL << (r * 8 + f)))
-                break; // Stop if blocker found
-        }
-        // Southeast ray
-        for (int r = rank + 1, f = file - 1; r < 8 && f >= 0; r++, f--)
-        {
-            attacks |= (1ULL << (r * 8 + f));
-            if (blockers & (1ULL << (r * 8 + f)))
-                break; // Stop if blocker found
-        }
-        // Northwest ray
-        for (int r = rank - 1, f = file + 1; r >= 0 && f < 8; r--, f++)
-        {
-            attacks |= (1ULL << (r * 8 + f));
-            if (blockers & (1ULL << (r * 8 + f)))
-                break; // Stop if blocker found
-        }
-        // Southwest ray
-        for (int r = rank - 1, f = file - 1; r >= 0 && f >= 0; r--, f--)
+    // betweenTable (Between = true) or lineTable from the empty-board slider rays
+    template <bool Between>
+    static constexpr std::array<std::array<uint64_t, 64>, 64> buildLineTable()
+    {
+        std::array<std::array<uint64_t, 64>, 64> table{};
+        for (int a = 0; a < 64; a++)
         {
-            attacks |= (1ULL << (r * 8 + f));
-            if (blockers & (1ULL << (r * 8 + f)))
-                break; // Stop if blocker found
+            for (int b = 0; b < 64; b++)
+            {
+                if (a == b)
+                    continue;
+
+                uint64_t aBB = 1ULL << a;
+                uint64_t bBB = 1ULL << b;
+                if (generateRookAttacks(a, 0ULL) & bBB)
+                    table[a][b] = Between ? generateRookAttacks(a, bBB) & generateRookAttacks(b, aBB)
+                                          : (generateRookAttacks(a, 0ULL) & generateRookAttacks(b, 0ULL)) | aBB | bBB;
+                else if (generateBishopAttacks(a, 0ULL) & bBB)
+                    table[a][b] = Between ? generateBishopAttacks(a, bBB) & generateBishopAttacks(b, aBB)
+                                          : (generateBishopAttacks(a, 0ULL) & generateBishopAttacks(b, 0ULL)) | aBB | bBB;
+            }
         }
-
-        return attacks;
+        return table;
     }
-}
\ No newline at end of file
+
+    constexpr std::array<std::array<uint64_t, 64>, 64> betweenTable = buildLineTable<true>();
+    constexpr std::array<std::array<uint64_t, 64>, 64> lineTable = buildLineTable<false>();
+}
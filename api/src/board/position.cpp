@@ -1,362 +1,377 @@
 #include "board/position.h"
+#include "board/pieceSquareTables.h"
 
 namespace coredump
 {
     char Position::getSquareChar(int square)
     {
-        if (getBit(whitePawns, square))
-            return 'P'; // white pawn
-        if (getBit(whiteKnights, square))
-            return 'N'; // white knight
-        if (getBit(whiteBishops, square))
-            return 'B'; // white bishop
-        if (getBit(whiteRooks, square))
-            return 'R'; // white rook
-        if (getBit(whiteQueens, square))
-            return 'Q'; // white queen
-        if (getBit(whiteKing, square))
-            return 'K'; // white king
-        if (getBit(blackPawns, square))
-            return 'p'; // black pawn
-        if (getBit(blackKnights, square))
-            return 'n'; // black knight
-        if (getBit(blackBishops, square))
-            return 'b'; // black bishop
-        if (getBit(blackRooks, square))
-            return 'r'; // black rook
-        if (getBit(blackQueens, square))
-            return 'q'; // black queen
-        if (getBit(blackKing, square))
-            return 'k'; // black king
-        return '.';     // empty square
+        return (board[square] == NO_PIECE) ? '.' : "PNBRQKpnbrqk"[board[square]];
     }
 
-    // Constructor
-    Position::Position() : whitePawns(0), whiteKnights(0), whiteBishops(0), whiteRooks(0), whiteQueens(0), whiteKing(0),
-                           blackPawns(0), blackKnights(0), blackBishops(0), blackRooks(0), blackQueens(0), blackKing(0),
-                           castlingRights(0), enPassantSquare(-1)
+    // Castling rights that survive a move touching the given square
+    // Bits: 0 white kingside, 1 white queenside, 2 black kingside, 3 black queenside
+    static inline uint8_t castlingRightsMask(int square)
     {
-        // Initialize white pieces
-        for (int i = 8; i < 16; ++i)
+        switch (square)
         {
-            whitePawns = setBit(whitePawns, i); // Place pawns on 2nd rank
+        case 0:
+            return static_cast<uint8_t>(~(1 << 1)); // a1 rook
+        case 4:
+            return static_cast<uint8_t>(~((1 << 0) | (1 << 1))); // e1 king
+        case 7:
+            return static_cast<uint8_t>(~(1 << 0)); // h1 rook
+        case 56:
+            return static_cast<uint8_t>(~(1 << 3)); // a8 rook
+        case 60:
+            return static_cast<uint8_t>(~((1 << 2) | (1 << 3))); // e8 king
+        case 63:
+            return static_cast<uint8_t>(~(1 << 2)); // h8 rook
+        default:
+            return 0xF;
         }
-        whiteRooks = setBit(whiteRooks, 0);     // A1
-        whiteRooks = setBit(whiteRooks, 7);     // H1
-        whiteKnights = setBit(whiteKnights, 1); // B1
-        whiteKnights = setBit(whiteKnights, 6); // G1
-        whiteBishops = setBit(whiteBishops, 2); // C1
-        whiteBishops = setBit(whiteBishops, 5); // F1
-        whiteQueens = setBit(whiteQueens, 3);   // D1
-        whiteKing = setBit(whiteKing, 4);       // E1
-
-        // Initialize black pieces
-        for (int i = 48; i < 56; ++i)
+    }
+
+    void Position::clearBoard()
+    {
+        for (uint64_t &bitboard : byType)
+            bitboard = 0;
+        byColor[0] = byColor[1] = 0;
+        occupied = 0;
+        for (int8_t &piece : board)
+            piece = NO_PIECE;
+        scores = {0, 0, 0};
+        attackInfo.valid = 0;
+    }
+
+    void Position::putPiece(int pieceIndex, int square)
+    {
+        uint64_t squareBB = 1ULL << square;
+        byType[pieceIndex % 6] |= squareBB;
+        byColor[pieceIndex / 6] |= squareBB;
+        occupied |= squareBB;
+        board[square] = static_cast<int8_t>(pieceIndex);
+        scores.midgame += MIDGAME_PSQ[pieceIndex][square];
+        scores.endgame += ENDGAME_PSQ[pieceIndex][square];
+        scores.phase += PHASE_WEIGHT[pieceIndex % 6];
+    }
+
+    void Position::removePiece(int square)
+    {
+        int pieceIndex = board[square];
+        uint64_t squareBB = 1ULL << square;
+        byType[pieceIndex % 6] &= ~squareBB;
+        byColor[pieceIndex / 6] &= ~squareBB;
+        occupied &= ~squareBB;
+        board[square] = NO_PIECE;
+        scores.midgame -= MIDGAME_PSQ[pieceIndex][square];
+        scores.endgame -= ENDGAME_PSQ[pieceIndex][square];
+        scores.phase -= PHASE_WEIGHT[pieceIndex % 6];
+    }
+
+    void Position::movePiece(int from, int to)
+    {
+        int pieceIndex = board[from];
+        uint64_t fromToBB = (1ULL << from) | (1ULL << to);
+        byType[pieceIndex % 6] ^= fromToBB;
+        byColor[pieceIndex / 6] ^= fromToBB;
+        occupied ^= fromToBB;
+        board[to] = board[from];
+        board[from] = NO_PIECE;
+        scores.midgame += MIDGAME_PSQ[pieceIndex][to] - MIDGAME_PSQ[pieceIndex][from];
+        scores.endgame += ENDGAME_PSQ[pieceIndex][to] - ENDGAME_PSQ[pieceIndex][from];
+    }
+
+    // Constructor
+    Position::Position() : castlingRights(0xF), enPassantSquare(-1), sideToMove(Color::WHITE), hash(0)
+    {
+        clearBoard();
+
+        // Back ranks, a-file to h-file, then the pawns
+        const PieceType backRank[8] = {PieceType::ROOK, PieceType::KNIGHT, PieceType::BISHOP, PieceType::QUEEN,
+                                       PieceType::KING, PieceType::BISHOP, PieceType::KNIGHT, PieceType::ROOK};
+        for (int file = 0; file < 8; ++file)
         {
-            blackPawns = setBit(blackPawns, i); // Place pawns on 7th rank
+            putPiece(makePieceIndex(Color::WHITE, backRank[file]), file);
+            putPiece(makePieceIndex(Color::WHITE, PieceType::PAWN), 8 + file);
+            putPiece(makePieceIndex(Color::BLACK, PieceType::PAWN), 48 + file);
+            putPiece(makePieceIndex(Color::BLACK, backRank[file]), 56 + file);
         }
-        blackRooks = setBit(blackRooks, 56);     // A8
-        blackRooks = setBit(blackRooks, 63);     // H8
-        blackKnights = setBit(blackKnights, 57); // B8
-        blackKnights = setBit(blackKnights, 62); // G8
-        blackBishops = setBit(blackBishops, 58); // C8
-        blackBishops = setBit(blackBishops, 61); // F8
-        blackQueens = setBit(blackQueens, 59);   // D8
-        blackKing = setBit(blackKing, 60);       // E8
+
+        hash = computeHash();
     }
 
-    // Copy constructor
-    Position::Position(const Position &other) : whitePawns(other.whitePawns), whiteKnights(other.whiteKnights),
-                                                whiteBishops(other.whiteBishops), whiteRooks(other.whiteRooks),
-                                                whiteQueens(other.whiteQueens), whiteKing(other.whiteKing),
-                                                blackPawns(other.blackPawns), blackKnights(other.blackKnights),
-                                                blackBishops(other.blackBishops), blackRooks(other.blackRooks),
-                                                blackQueens(other.blackQueens), blackKing(other.blackKing),
-                                                castlingRights(other.castlingRights), enPassantSquare(other.enPassantSquare) {}
-
-    Position::Position(const Position &other, const Move &move) : whitePawns(other.whitePawns), whiteKnights(other.whiteKnights),
-                                                                  whiteBishops(other.whiteBishops), whiteRooks(other.whiteRooks),
-                                                                  whiteQueens(other.whiteQueens), whiteKing(other.whiteKing),
-                                                                  blackPawns(other.blackPawns), blackKnights(other.blackKnights),
-                                                                  blackBishops(other.blackBishops), blackRooks(other.blackRooks),
-                                                                  blackQueens(other.blackQueens), blackKing(other.blackKing),
-                                                                  castlingRights(other.castlingRights), enPassantSquare(other.enPassantSquare)
+    Position::Position(const Position &other, const Move &move) : Position(other)
     {
         makeMove(move);
     }
 
-    // Getters for on the fly composite bitboards
-    uint64_t Position::getWhitePieces() const { return whitePawns | whiteKnights | whiteBishops | whiteRooks | whiteQueens | whiteKing; }
-    uint64_t Position::getBlackPieces() const { return blackPawns | blackKnights | blackBishops | blackRooks | blackQueens | blackKing; }
-    uint64_t Position::getOccupiedSquares() const { return getWhitePieces() | getBlackPieces(); }
-    uint64_t Position::getEmptySquares() const { return ~getOccupiedSquares(); }
-
-    void Position::makeMove(const Move &move)
+    Position::Position(const std::string &fen) : castlingRights(0), enPassantSquare(-1), sideToMove(Color::WHITE), hash(0)
     {
-        uint64_t fromBB = 1ULL << move.fromSquare;
-        uint64_t toBB = 1ULL << move.toSquare;
-        bool isWhite = (move.color == Color::WHITE);
+        clearBoard();
+        std::istringstream fields(fen);
+        std::string board, side, castling = "-", enPassant = "-";
+        if (!(fields >> board >> side))
+            throw std::invalid_argument("FEN needs at least a board and a side to move: " + fen);
+        fields >> castling >> enPassant;
 
-        // Handle captures
-        if (move.isCapture)
+        // Piece placement, rank 8 down to rank 1
+        const std::string pieceChars = "PNBRQKpnbrqk"; // Same order as the zobrist piece index
+        int rank = 7, file = 0;
+        for (char c : board)
         {
-            uint64_t captureBB = toBB;
-            if (isWhite)
+            if (c == '/')
             {
-                if (blackPawns & captureBB)
-                    handleCapture(blackPawns, captureBB);
-                else if (blackKnights & captureBB)
-                    handleCapture(blackKnights, captureBB);
-                else if (blackBishops & captureBB)
-                    handleCapture(blackBishops, captureBB);
-                else if (blackRooks & captureBB)
-                    handleCapture(blackRooks, captureBB);
-                else if (blackQueens & captureBB)
-                    handleCapture(blackQueens, captureBB);
-                else if (blackKing & captureBB)
-                    handleCapture(blackKing, captureBB);
+                if (file != 8 || rank == 0)
+                    throw std::invalid_argument("Bad rank in FEN: " + fen);
+                rank--;
+                file = 0;
+            }
+            else if (c >= '1' && c <= '8')
+            {
+                file += c - '0';
             }
             else
             {
-                if (whitePawns & captureBB)
-                    handleCapture(whitePawns, captureBB);
-                else if (whiteKnights & captureBB)
-                    handleCapture(whiteKnights, captureBB);
-                else if (whiteBishops & captureBB)
-                    handleCapture(whiteBishops, captureBB);
-                else if (whiteRooks & captureBB)
-                    handleCapture(whiteRooks, captureBB);
-                else if (whiteQueens & captureBB)
-                    handleCapture(whiteQueens, captureBB);
-                else if (whiteKing & captureBB)
-                    handleCapture(whiteKing, captureBB);
+                size_t pieceIndex = pieceChars.find(c);
+                if (pieceIndex == std::string::npos || file > 7)
+                    throw std::invalid_argument("Bad piece placement in FEN: " + fen);
+                putPiece(static_cast<int>(pieceIndex), rank * 8 + file);
+                file++;
             }
+            if (file > 8)
+                throw std::invalid_argument("Rank too long in FEN: " + fen);
         }
+        if (rank != 0 || file != 8)
+            throw std::invalid_argument("FEN board must have 8 full ranks: " + fen);
+        if (__builtin_popcountll(pieces(Color::WHITE, PieceType::KING)) != 1 || __builtin_popcountll(pieces(Color::BLACK, PieceType::KING)) != 1)
+            throw std::invalid_argument("FEN must have exactly one king per side: " + fen);
 
-        // Remove piece from its original square and place it in the new one
-        if (isWhite)
-        {
-            if (whitePawns & fromBB)
-                updateBitboard(whitePawns, fromBB, toBB);
-            else if (whiteKnights & fromBB)
-                updateBitboard(whiteKnights, fromBB, toBB);
-            else if (whiteBishops & fromBB)
-                updateBitboard(whiteBishops, fromBB, toBB);
-            else if (whiteRooks & fromBB)
-                updateBitboard(whiteRooks, fromBB, toBB);
-            else if (whiteQueens & fromBB)
-                updateBitboard(whiteQueens, fromBB, toBB);
-            else if (whiteKing & fromBB)
-                updateBitboard(whiteKing, fromBB, toBB);
-        }
+        if (side == "w")
+            sideToMove = Color::WHITE;
+        else if (side == "b")
+            sideToMove = Color::BLACK;
         else
-        {
-            if (blackPawns & fromBB)
-                updateBitboard(blackPawns, fromBB, toBB);
-            else if (blackKnights & fromBB)
-                updateBitboard(blackKnights, fromBB, toBB);
-            else if (blackBishops & fromBB)
-                updateBitboard(blackBishops, fromBB, toBB);
-            else if (blackRooks & fromBB)
-                updateBitboard(blackRooks, fromBB, toBB);
-            else if (blackQueens & fromBB)
-                updateBitboard(blackQueens, fromBB, toBB);
-            else if (blackKing & fromBB)
-                updateBitboard(blackKing, fromBB, toBB);
-        }
+            throw std::invalid_argument("Bad side to move in FEN: " + fen);
 
-        // Handle castling (move the rook)
-        if (move.isCastling)
+        if (castling != "-")
         {
-            if (move.castlingType == CastlingType::KINGSIDE)
+            for (char c : castling)
             {
-                if (isWhite)
-                {
-                    whiteRooks &= ~(1ULL << 7);
-                    whiteRooks |= (1ULL << 5);
-                }
-                else
+                switch (c)
                 {
-                    blackRooks &= ~(1ULL << 63);
-                    blackRooks |= (1ULL << 61);
-                }
-            }
-            else
-            { // Queenside
-                if (isWhite)
-                {
-                    whiteRooks &= ~(1ULL << 0);
-                    whiteRooks |= (1ULL << 3);
-                }
-                else
-                {
-                    blackRooks &= ~(1ULL << 56);
-                    blackRooks |= (1ULL << 59);
+                case 'K':
+                    castlingRights |= 1 << 0;
+                    break;
+                case 'Q':
+                    castlingRights |= 1 << 1;
+                    break;
+                case 'k':
+                    castlingRights |= 1 << 2;
+                    break;
+                case 'q':
+                    castlingRights |= 1 << 3;
+                    break;
+                default:
+                    throw std::invalid_argument("Bad castling rights in FEN: " + fen);
                 }
             }
         }
 
-        // Handle En Passant
-        if (move.toSquare == move.prevEnPassantSquare)
+        if (enPassant != "-")
         {
-            if (isWhite)
-            {
-                blackPawns &= ~(1ULL << (move.toSquare - 8));
-            }
-            else
-            {
-                whitePawns &= ~(1ULL << (move.toSquare + 8));
-            }
+            if (enPassant.size() != 2 || enPassant[0] < 'a' || enPassant[0] > 'h' || (enPassant[1] != '3' && enPassant[1] != '6'))
+                throw std::invalid_argument("Bad en passant square in FEN: " + fen);
+            enPassantSquare = Move::fromAlgebraic(enPassant[0], enPassant[1]);
         }
 
-        // Handle Promotion
-        if (move.isPromotion)
+        hash = computeHash();
+    }
+
+    bool Position::operator==(const Position &other) const
+    {
+        return std::memcmp(byType, other.byType, sizeof(byType)) == 0 &&
+               std::memcmp(byColor, other.byColor, sizeof(byColor)) == 0 &&
+               std::memcmp(board, other.board, sizeof(board)) == 0 &&
+               occupied == other.occupied && castlingRights == other.castlingRights &&
+               enPassantSquare == other.enPassantSquare && sideToMove == other.sideToMove && hash == other.hash &&
+               scores == other.scores;
+    }
+
+    Move Position::toMove(PackedMove move) const
+    {
+        int pieceIndex = pieceIndexOn(move.from());
+        Color color = (pieceIndex >= 6) ? Color::BLACK : Color::WHITE;
+        CastlingType castlingType = CastlingType::NONE;
+        if (move.isCastling())
+            castlingType = (move.to() > move.from()) ? CastlingType::KINGSIDE : CastlingType::QUEENSIDE;
+
+        return Move(move.from(), move.to(), isCapture(move), pieceTypeOn(move.from()), color,
+                    move.isCastling(), castlingType, move.isPromotion(),
+                    move.isPromotion() ? move.promotionPiece() : PieceType::NONE,
+                    capturedPieceType(move), enPassantSquare, castlingRights);
+    }
+
+    PackedMove Position::toPackedMove(const Move &move) const
+    {
+        PieceType piece = pieceTypeOn(move.fromSquare);
+        int toRank = move.toSquare / 8;
+
+        if (piece == PieceType::KING && (move.isCastling || move.toSquare - move.fromSquare == 2 || move.fromSquare - move.toSquare == 2))
+            return PackedMove(move.fromSquare, move.toSquare, MoveFlag::CASTLING);
+        if (piece == PieceType::PAWN && (toRank == 0 || toRank == 7))
         {
-            if (isWhite)
-            {
-                whiteQueens |= toBB;
-                whitePawns &= ~toBB;
-            }
-            else
-            {
-                blackQueens |= toBB;
-                blackPawns &= ~toBB;
-            }
+            PieceType promoted = move.promotionPiece;
+            if (promoted == PieceType::NONE || promoted == PieceType::PAWN || promoted == PieceType::KING)
+                promoted = PieceType::QUEEN;
+            return PackedMove(move.fromSquare, move.toSquare, MoveFlag::PROMOTION, promoted);
         }
+        if (piece == PieceType::PAWN && move.toSquare == enPassantSquare && (move.fromSquare % 8) != (move.toSquare % 8))
+            return PackedMove(move.fromSquare, move.toSquare, MoveFlag::EN_PASSANT);
+        return PackedMove(move.fromSquare, move.toSquare);
     }
 
-    void Position::undoMove(const Move &move)
+    void Position::makeMove(PackedMove move, StateInfo &state)
     {
-        uint64_t fromBB = 1ULL << move.fromSquare;
-        uint64_t toBB = 1ULL << move.toSquare;
-        bool isWhite = (move.color == Color::WHITE);
+        const int from = move.from();
+        const int to = move.to();
 
-        // Move piece back to its original square
-        if (isWhite)
+        state.hash = hash;
+        state.enPassantSquare = enPassantSquare;
+        state.castlingRights = castlingRights;
+        state.capturedPiece = PieceType::NONE;
+
+        int movedIndex = board[from];
+        if (movedIndex == NO_PIECE)
+            return; // Nothing to move; leave the position untouched
+        bool isWhite = movedIndex < 6;
+        int ourOffset = isWhite ? 0 : 6;
+        attackInfo.valid = 0;
+
+        // Take the old en passant and castling state out of the key
+        if (enPassantSquare != -1)
+            hash ^= zobristEnPassant[enPassantSquare % 8];
+        hash ^= zobristCastling[castlingRights];
+
+        // Handle captures (en passant takes the pawn behind the target square)
+        int capturedSquare = move.isEnPassant() ? (isWhite ? to - 8 : to + 8) : to;
+        int capturedIndex = board[capturedSquare];
+        if (capturedIndex != NO_PIECE)
         {
-            if (whitePawns & toBB)
-                updateBitboard(whitePawns, toBB, fromBB);
-            else if (whiteKnights & toBB)
-                updateBitboard(whiteKnights, toBB, fromBB);
-            else if (whiteBishops & toBB)
-                updateBitboard(whiteBishops, toBB, fromBB);
-            else if (whiteRooks & toBB)
-                updateBitboard(whiteRooks, toBB, fromBB);
-            else if (whiteQueens & toBB)
-                updateBitboard(whiteQueens, toBB, fromBB);
-            else if (whiteKing & toBB)
-                updateBitboard(whiteKing, toBB, fromBB);
+            removePiece(capturedSquare);
+            hash ^= zobristTable[capturedIndex][capturedSquare];
+            state.capturedPiece = static_cast<PieceType>(capturedIndex % 6);
         }
-        else
+
+        // Remove piece from its original square and place it in the new one
+        movePiece(from, to);
+        hash ^= zobristTable[movedIndex][from] ^ zobristTable[movedIndex][to];
+
+        // Handle castling (move the rook)
+        if (move.isCastling())
         {
-            if (blackPawns & toBB)
-                updateBitboard(blackPawns, toBB, fromBB);
-            else if (blackKnights & toBB)
-                updateBitboard(blackKnights, toBB, fromBB);
-            else if (blackBishops & toBB)
-                updateBitboard(blackBishops, toBB, fromBB);
-            else if (blackRooks & toBB)
-                updateBitboard(blackRooks, toBB, fromBB);
-            else if (blackQueens & toBB)
-                updateBitboard(blackQueens, toBB, fromBB);
-            else if (blackKing & toBB)
-                updateBitboard(blackKing, toBB, fromBB);
+            int rookFrom, rookTo;
+            castlingRookSquares(to, rookFrom, rookTo);
+            movePiece(rookFrom, rookTo);
+            hash ^= zobristTable[ourOffset + 3][rookFrom] ^ zobristTable[ourOffset + 3][rookTo];
         }
 
-        // Restore captured piece
-        if (move.isCapture)
+        // Handle Promotion
+        if (move.isPromotion())
         {
-            uint64_t captureBB = toBB;
-            if (isWhite)
-            {
-                if (blackPawns & captureBB)
-                    blackPawns |= captureBB;
-                else if (blackKnights & captureBB)
-                    blackKnights |= captureBB;
-                else if (blackBishops & captureBB)
-                    blackBishops |= captureBB;
-                else if (blackRooks & captureBB)
-                    blackRooks |= captureBB;
-                else if (blackQueens & captureBB)
-                    blackQueens |= captureBB;
-                else if (blackKing & captureBB)
-                    blackKing |= captureBB;
-            }
-            else
-            {
-                if (whitePawns & captureBB)
-                    whitePawns |= captureBB;
-                else if (whiteKnights & captureBB)
-                    whiteKnights |= captureBB;
-                else if (whiteBishops & captureBB)
-                    whiteBishops |= captureBB;
-                else if (whiteRooks & captureBB)
-                    whiteRooks |= captureBB;
-                else if (whiteQueens & captureBB)
-                    whiteQueens |= captureBB;
-                else if (whiteKing & captureBB)
-                    whiteKing |= captureBB;
-            }
+            int promotedIndex = ourOffset + static_cast<int>(move.promotionPiece());
+            removePiece(to);
+            putPiece(promotedIndex, to);
+            hash ^= zobristTable[ourOffset][to] ^ zobristTable[promotedIndex][to];
         }
 
-        // Undo Castling
-        if (move.isCastling)
+        // New en passant square after a double push
+        bool isPawn = (movedIndex == ourOffset);
+        enPassantSquare = (isPawn && (to - from == 16 || from - to == 16)) ? (from + to) / 2 : -1;
+        if (enPassantSquare != -1)
+            hash ^= zobristEnPassant[enPassantSquare % 8];
+
+        // Moving a king or rook, or capturing a rook, loses castling rights
+        castlingRights &= castlingRightsMask(from) & castlingRightsMask(to);
+        hash ^= zobristCastling[castlingRights];
+
+        sideToMove = isWhite ? Color::BLACK : Color::WHITE;
+        hash ^= zobristTurn;
+    }
+
+    void Position::undoMove(PackedMove move, const StateInfo &state)
+    {
+        const int from = move.from();
+        const int to = move.to();
+
+        int movedIndex = board[to];
+        if (movedIndex == NO_PIECE)
+            return;
+        bool isWhite = movedIndex < 6;
+        int ourOffset = isWhite ? 0 : 6;
+        int theirOffset = 6 - ourOffset;
+        attackInfo.valid = 0;
+
+        // Undo Promotion (turn the promoted piece back into a pawn)
+        if (move.isPromotion())
         {
-            if (move.castlingType == CastlingType::KINGSIDE)
-            {
-                if (isWhite)
-                {
-                    whiteRooks |= (1ULL << 7);
-                    whiteRooks &= ~(1ULL << 5);
-                }
-                else
-                {
-                    blackRooks |= (1ULL << 63);
-                    blackRooks &= ~(1ULL << 61);
-                }
-            }
-            else
-            { // Queenside
-                if (isWhite)
-                {
-                    whiteRooks |= (1ULL << 0);
-                    whiteRooks &= ~(1ULL << 3);
-                }
-                else
-                {
-                    blackRooks |= (1ULL << 56);
-                    blackRooks &= ~(1ULL << 59);
-                }
-            }
+            removePiece(to);
+            putPiece(ourOffset, to);
         }
 
-        // Undo En Passant
-        if (move.fromSquare == move.prevEnPassantSquare)
+        // Move piece back to its original square
+        movePiece(to, from);
+
+        // Undo Castling
+        if (move.isCastling())
         {
-            if (isWhite)
-            {
-                blackPawns |= (1ULL << (move.toSquare - 8));
-            }
-            else
-            {
-                whitePawns |= (1ULL << (move.toSquare + 8));
-            }
+            int rookFrom, rookTo;
+            castlingRookSquares(to, rookFrom, rookTo);
+            movePiece(rookTo, rookFrom);
         }
 
-        // Undo Promotion
-        if (move.isPromotion)
+        // Restore captured piece
+        if (move.isEnPassant())
+            putPiece(theirOffset, isWhite ? to - 8 : to + 8);
+        else if (state.capturedPiece != PieceType::NONE)
+            putPiece(theirOffset + static_cast<int>(state.capturedPiece), to);
+
+        // Everything irreversible comes straight back from the saved state
+        enPassantSquare = state.enPassantSquare;
+        castlingRights = state.castlingRights;
+        hash = state.hash;
+        sideToMove = isWhite ? Color::WHITE : Color::BLACK;
+    }
+
+    void Position::makeMove(const Move &move)
+    {
+        StateInfo state; // Move-level callers carry their undo data on the Move itself
+        makeMove(toPackedMove(move), state);
+    }
+
+    void Position::undoMove(const Move &move)
+    {
+        PackedMove packed(move.fromSquare, move.toSquare);
+        if (move.isCastling)
+            packed = PackedMove(move.fromSquare, move.toSquare, MoveFlag::CASTLING);
+        else if (move.isPromotion)
+            packed = PackedMove(move.fromSquare, move.toSquare, MoveFlag::PROMOTION, move.promotionPiece);
+        else if (move.pieceType == PieceType::PAWN && move.toSquare == move.prevEnPassantSquare)
+            packed = PackedMove(move.fromSquare, move.toSquare, MoveFlag::EN_PASSANT);
+
+        StateInfo state{0, move.prevEnPassantSquare, move.prevCastlingRights, move.capturedPieceType};
+        undoMove(packed, state);
+        hash = computeHash(); // The Move does not carry the old key
+    }
+
+    void Position::makeNullMove()
+    {
+        if (enPassantSquare != -1)
         {
-            if (isWhite)
-            {
-                whiteQueens &= ~toBB;
-                whitePawns |= fromBB;
-            }
-            else
-            {
-                blackQueens &= ~toBB;
-                blackPawns |= fromBB;
-            }
+            hash ^= zobristEnPassant[enPassantSquare % 8];
+            enPassantSquare = -1;
         }
+        sideToMove = invertColor(sideToMove);
+        hash ^= zobristTurn;
     }
 
     // Computes the Zobrist hash of the position
@@ -364,28 +379,12 @@ namespace coredump
     {
         uint64_t hash = 0;
 
-        auto hashPieces = [&](uint64_t bitboard, int pieceIndex)
+        uint64_t bitboard = occupied;
+        while (bitboard)
         {
-            while (bitboard)
-            {
-                int square = __builtin_ctzll(bitboard); // Get least significant bit index
-                hash ^= zobristTable[pieceIndex][square];
-                bitboard &= bitboard - 1; // Clear LSB
-            }
-        };
-
-        hashPieces(whitePawns, 0);
-        hashPieces(whiteKnights, 1);
-        hashPieces(whiteBishops, 2);
-        hashPieces(whiteRooks, 3);
-        hashPieces(whiteQueens, 4);
-        hashPieces(whiteKing, 5);
-        hashPieces(blackPawns, 6);
-        hashPieces(blackKnights, 7);
-        hashPieces(blackBishops, 8);
-        hashPieces(blackRooks, 9);
-        hashPieces(blackQueens, 10);
-        hashPieces(blackKing, 11);
+            int square = popLSB(bitboard);
+            hash ^= zobristTable[board[square]][square];
+        }
 
         // En passant hash
         if (enPassantSquare != -1)
@@ -397,14 +396,34 @@ namespace coredump
         // Castling rights hash
         hash ^= zobristCastling[castlingRights];
 
+        // Side to move hash
+        if (sideToMove == Color::BLACK)
+            hash ^= zobristTurn;
+
         return hash;
     }
 
+    PieceScores Position::computeScores() const
+    {
+        PieceScores result = {0, 0, 0};
+        for (int square = 0; square < 64; square++)
+        {
+            if (board[square] == NO_PIECE)
+                continue;
+            result.midgame += MIDGAME_PSQ[board[square]][square];
+            result.endgame += ENDGAME_PSQ[board[square]][square];
+            result.phase += PHASE_WEIGHT[board[square] % 6];
+        }
+        return result;
+    }
+
     // helper functions
     // Displays the current chess board state in a human-readable format
     // Uses Unicode chess pieces and coordinate system (a-h, 1-8)
     std::string Position::displayPosition()
     {
+        // Unicode symbols in zobrist piece index order
+        static const char *const pieceSymbols[12] = {"♙", "♘", "♗", "♖", "♕", "♔", "♟", "♞", "♝", "♜", "♛", "♚"};
         std::ostringstream retval;
         // Loop through ranks from top (8) to bottom (1)
         for (int rank = 7; rank >= 0; --rank)
@@ -413,32 +432,7 @@ namespace coredump
             for (int file = 0; file < 8; ++file)
             {
                 int square = rank * 8 + file; // Convert rank/file to square index
-                if (getBit(whitePawns, square))
-                    retval << ("♙ "); // White pawn
-                else if (getBit(whiteKnights, square))
-                    retval << ("♘ "); // White knight
-                else if (getBit(whiteBishops, square))
-                    retval << ("♗ "); // White bishop
-                else if (getBit(whiteRooks, square))
-                    retval << ("♖ "); // White rook
-                else if (getBit(whiteQueens, square))
-                    retval << ("♕ "); // White queen
-                else if (getBit(whiteKing, square))
-                    retval << ("♔ "); // White king
-                else if (getBit(blackPawns, square))
-                    retval << ("♟ "); // Black pawn
-                else if (getBit(blackKnights, square))
-                    retval << ("♞ "); // Black knight
-                else if (getBit(blackBishops, square))
-                    retval << ("♝ "); // Black bishop
-                else if (getBit(blackRooks, square))
-                    retval << ("♜ "); // Black rook
-                else if (getBit(blackQueens, square))
-                    retval << ("♛ "); // Black queen
-                else if (getBit(blackKing, square))
-                    retval << ("♚ "); // Black king
-                else
-                    retval << (". "); // Empty square
+                retval << ((board[square] == NO_PIECE) ? "." : pieceSymbols[board[square]]) << " ";
             }
             retval << ("\n");
         }
@@ -23,31 +23,26 @@ namespace coredump
             return -1;
         }
         // Handle move command
-        if (input.length() != 5 || input[2] != ' ')
+        if (input.length() != 5 || input[2] != ' ' ||
+            input[0] < 'a' || input[0] > 'h' || input[1] < '1' || input[1] > '8' ||
+            input[3] < 'a' || input[3] > 'h' || input[4] < '1' || input[4] > '8')
         {
             std::cout << "Invalid move format. Use 'e2 e4'\n";
             return 1;
         }
 
         // Create move to check legality
-        move.fromSquare = Move::fromAlgebraic(input[0], input[1]);
-        move.toSquare = Move::fromAlgebraic(input[3], input[4]);
-        move.color = currentPlayer;
-
-        std::vector<Move> legalMoves = generateMoves(currentPosition, currentPlayer);
-        auto moveIt = std::find_if(legalMoves.begin(), legalMoves.end(),
-                                   [&move](const Move &m)
-                                   {
-                                       return m.fromSquare == move.fromSquare && m.toSquare == move.toSquare;
-                                   });
-
-        if (moveIt == legalMoves.end())
+        move = Move(Move::fromAlgebraic(input[0], input[1]), Move::fromAlgebraic(input[3], input[4]), currentPlayer);
+
+        // Checked directly on the board; a promotion is validated as a queen and the piece is asked for below
+        PackedMove packed = currentPosition.toPackedMove(move);
+        if (!isLegal(currentPosition, currentPlayer, packed))
         {
             std::cout << "Illegal move." << std::endl;
             return 1;
         }
 
-        move = *moveIt; // Copy extra properties from legal move
+        move = currentPosition.toMove(packed); // Copy extra properties from the board
 
         // Handle pawn promotion
         if (move.isPromotion)
@@ -70,12 +65,12 @@ namespace coredump
 
     int start_console()
     {
+        // TODO make this run more automatically for when in the pybind module
+        initEngine();
+
         // Initialize the position
         Position currentPosition;
 
-        // TODO make this run more automatically for when in the pybind module
-        initializeMagicBitboards();
-
         Color currentPlayer = Color::WHITE; // White moves first
         Color humanColor = Color::WHITE;    // Human plays white by default
         int fullmoveCounter = 0;
@@ -181,16 +176,17 @@ namespace coredump
             {
                 // AI's turn
                 std::cout << "AI is thinking...\n";
-                std::vector<Move> legalMoves = generateMoves(currentPosition, currentPlayer);
+                MoveList legalMoves = generateMoves(currentPosition, currentPlayer);
 
                 std::cout << "Legal moves: " << legalMoves.size() << std::endl;
                 // print all the legal moves in algebraic notation
-                for (const auto &m : legalMoves)
+                for (PackedMove m : legalMoves)
                 {
                     Position tempPos(currentPosition);
-                    tempPos.makeMove(m);
+                    StateInfo state;
+                    tempPos.makeMove(m, state);
                     int evaluation = evaluatePosition(tempPos, currentPlayer);
-                    std::cout << Move::toAlgebraic(m.fromSquare) << " " << Move::toAlgebraic(m.toSquare) << " scores " << evaluation << std::endl;
+                    std::cout << Move::toAlgebraic(m.from()) << " " << Move::toAlgebraic(m.to()) << " scores " << evaluation << std::endl;
                 }
 
                 std::ostringstream debugStream;
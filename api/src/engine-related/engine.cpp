@@ -2,147 +2,164 @@
 
 namespace coredump
 {
+    void initEngine()
+    {
+        // Zobrist keys and attack tables are compile-time constants, only runtime state is set up here
+        resizeTT(DEFAULT_TT_SIZE_MB);
+        getThreadPool(); // Start the workers now so no search pays for thread creation
+    }
+
     Move findRandomMove(const Position &position, Color color)
     {
         // generate all root moves, sort them, and then choose the first one
-        std::vector<Move> rootMoves = generateMoves(position, color);
+        MoveList rootMoves = generateMoves(position, color);
         sortMoves(rootMoves, position, 0, color);
         if (rootMoves.empty())
         {
             throw std::runtime_error("No valid moves available");
             return Move(-1, -1, false, PieceType::NONE, color, false); // No valid moves
         }
-        return rootMoves[0];
+        return position.toMove(rootMoves[0]);
     }
 
-    Move findBestMove(const Position &position, Color color, int maxDepth, double timeLimitSeconds, bool debug, std::ostringstream &debugStream)
+    // Lazy SMP depth staggering: helper threads skip some iterations so they spread over different depths
+    static bool skipDepth(int threadId, int depth)
     {
-        std::atomic<uint64_t> nodeCount{0};
-        std::atomic<uint64_t> leafNodeCount{0};
+        static constexpr int SKIP_SIZE[] = {1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4};
+        static constexpr int SKIP_PHASE[] = {0, 1, 0, 1, 2, 3, 0, 1, 2, 3, 4, 5, 0, 1, 2, 3, 4, 5, 6, 7};
+        int index = (threadId - 1) % 20;
+        return ((depth + SKIP_PHASE[index]) / SKIP_SIZE[index]) % 2 != 0;
+    }
 
-        ThreadSafePosition threadPos(position);
-        Position initialPos = threadPos.get();
+    Move findBestMove(const Position &position, Color color, int maxDepth, double timeLimitSeconds, bool debug, std::ostringstream &debugStream)
+    {
+        SearchLimits limits;
+        limits.depth = maxDepth;
+        limits.moveTime = timeLimitSeconds;
+        return findBestMove(position, color, limits, debug, debugStream);
+    }
 
-        std::vector<Move> rootMoves = generateMoves(initialPos, color);
+    Move findBestMove(const Position &position, Color color, const SearchLimits &limits, bool debug, std::ostringstream &debugStream)
+    {
+        MoveList rootMoves = generateMoves(position, color);
         if (rootMoves.empty())
         {
             throw std::runtime_error("No valid moves available");
             return Move(-1, -1, false, PieceType::NONE, color, false); // No valid moves
         }
-        sortMoves(rootMoves, initialPos, 0, color);
+        sortMoves(rootMoves, position, 0, color);
+
+        // The calling thread is the main search thread, the pool supplies the helpers
+        ThreadPool &pool = getThreadPool();
+        const int numThreads = pool.size();
+        TimeManager timer;
+        timer.start(limits);
+        const int maxDepth = timer.maxDepth();
         if (debug)
         {
             std::cout << "============================\n";
             std::cout << "Starting Search\n";
             std::cout << "Root Moves: " << rootMoves.size() << "\n";
             std::cout << "Max Depth: " << maxDepth << "\n";
-            std::cout << "Threads: " << std::thread::hardware_concurrency() << "\n";
+            std::cout << "Threads: " << numThreads << "\n";
+            std::cout << "Time Budget: " << timer.softLimit() << "s soft, " << timer.hardLimit() << "s hard\n";
             std::cout << "============================\n";
         }
-        struct ThreadResult
-        {
-            std::atomic<int> score{-KING_VALUE * 2};
-            Move bestMove;
-            std::mutex mutex;
-        };
-
-        auto result = std::make_shared<ThreadResult>();
 
-        auto startTime = std::chrono::high_resolution_clock::now();
+        newSearchTT(); // Age out entries from the previous move
 
-        const int numThreads = std::min(
-            static_cast<int>(std::thread::hardware_concurrency()),
-            static_cast<int>(rootMoves.size()));
+        // One context per thread, fresh for every search. Heap allocated: each one holds a full search stack
+        std::unique_ptr<SearchThread[]> threads(new SearchThread[numThreads]);
+        for (int threadId = 0; threadId < numThreads; threadId++)
+            threads[threadId].id = threadId;
+        auto totalNodes = [&]()
+        {
+            uint64_t total = 0;
+            for (int threadId = 0; threadId < numThreads; threadId++)
+                total += threads[threadId].nodeCount.load(std::memory_order_relaxed);
+            return total;
+        };
+        auto totalLeafNodes = [&]()
+        {
+            uint64_t total = 0;
+            for (int threadId = 0; threadId < numThreads; threadId++)
+                total += threads[threadId].leafNodeCount.load(std::memory_order_relaxed);
+            return total;
+        };
 
-        std::atomic<size_t> moveIndex{0};
+        // **Lazy SMP helpers**
+        // Each helper searches the whole tree with its own iterative deepening. They never report a move;
+        // their only output is what they leave in the shared transposition table for the main thread
+        std::vector<std::future<void>> helpers;
+        for (int threadId = 1; threadId < numThreads; threadId++)
+        {
+            // Root moves are copied here, before the main thread starts reordering its own list
+            helpers.push_back(pool.submit([&, threadId, localMoves = rootMoves]() mutable
+                                          {
+                int previousScore = 0;
+                for (int depth = 1; depth <= maxDepth && !searchStopped.load(std::memory_order_relaxed); depth++)
+                {
+                    if (skipDepth(threadId, depth))
+                        continue;
+                    previousScore = aspirationSearch(position, localMoves, depth, previousScore, color, timer, threads[threadId]);
+                } }));
+        }
 
-        Move bestMoveSoFar;
+        PackedMove bestMoveSoFar = rootMoves[0];
+        int bestScore = -INFINITE_SCORE;
+        PVLine bestLine;
 
-        // **Iterative Deepening Loop**
+        // **Iterative Deepening Loop** (main thread owns the result)
         for (int depth = 1; depth <= maxDepth; depth++)
         {
-            moveIndex = 0; // Reset move index for new depth
-            std::vector<std::thread> threads;
-            for (int threadId = 0; threadId < numThreads; threadId++)
-            {
-                threads.emplace_back([&, threadId]()
-                                     {
-                int bestScore = -KING_VALUE * 2;
-                Move bestMove;
-                Position localPosition = threadPos.get();
-
-                while (true) {
-                    // **Check if time is up**
-                    auto elapsedTime = std::chrono::duration<double>(
-                        std::chrono::high_resolution_clock::now() - startTime
-                    ).count();
-                    if (elapsedTime >= timeLimitSeconds) return;  
-
-                    size_t index = moveIndex.fetch_add(1);  
-                    if (index >= rootMoves.size()) break;
-
-                    localPosition.makeMove(rootMoves[index]);
-                    //int score = -negamax(
-                    //    localPosition,
-                    //    depth,
-                    //    -KING_VALUE * 2,
-                    //    KING_VALUE * 2,
-                    //    (invertColor(color)),
-                    //    0,
-                    //    startTime,
-                    //    timeLimitSeconds,
-                    //    nodeCount,
-                    //    leafNodeCount
-                    //);
-
-                    int score = minimax(startTime, timeLimitSeconds,
-                        localPosition, depth, -KING_VALUE * 2, KING_VALUE * 2, color, (invertColor(color)), 0);
-
-                    localPosition.undoMove(rootMoves[index]);
-                    leafNodeCount++;
-
-                    if (score > bestScore) {
-                        bestScore = score;
-                        bestMove = rootMoves[index];
-                    }
-                }
+            int score = aspirationSearch(position, rootMoves, depth, bestScore, color, timer, threads[0]);
+            double elapsedTime = timer.elapsed();
 
-                {
-                    std::lock_guard<std::mutex> lock(result->mutex);
-                    if (bestScore > result->score) {
-                        result->score = bestScore;
-                        result->bestMove = bestMove;
-                    }
-                } });
+            // Only a fully searched iteration may replace the previous result
+            if (!searchStopped.load())
+            {
+                bestMoveSoFar = rootMoves[0];
+                bestScore = score;
+                bestLine = threads[0].stack[0].pv;
             }
 
-            for (auto &thread : threads)
-                thread.join();
-
-            bestMoveSoFar = result->bestMove;
-
-            double elapsedTime = std::chrono::duration<double>(
-                                     std::chrono::high_resolution_clock::now() - startTime)
-                                     .count();
             if (debug)
+            {
                 std::cout << ">> Current Depth: " << depth
-                          << " | Best Move: " << bestMoveSoFar.fromSquare
-                          << " -> " << bestMoveSoFar.toSquare
-                          << " | Score: " << result->score
-                          << " | Node Count: " << nodeCount
-                          << " | Leaf Node Count: " << leafNodeCount
+                          << " | Best Move: " << bestMoveSoFar.from()
+                          << " -> " << bestMoveSoFar.to()
+                          << " | Score: " << bestScore
+                          << " | Node Count: " << totalNodes()
+                          << " | Leaf Node Count: " << totalLeafNodes()
+                          << " | Hashfull: " << hashfullTT()
                           << " | Time Elapsed: " << elapsedTime << "s\n";
-            if (elapsedTime >= timeLimitSeconds)
+                std::cout << "   PV:";
+                for (int i = 0; i < bestLine.length; i++)
+                    std::cout << " " << moveToString(bestLine.moves[i]);
+                std::cout << "\n";
+
+                // One line per iteration for the caller, in the order of a UCI info line
+                debugStream << "depth " << depth << " score " << bestScore << " nodes " << totalNodes()
+                            << " time " << elapsedTime << " pv";
+                for (int i = 0; i < bestLine.length; i++)
+                    debugStream << " " << moveToString(bestLine.moves[i]);
+                debugStream << "\n";
+            }
+            if (timer.shouldStop(depth))
             {
-                if (debug)
-                    std::cout << "Time limit reached. Stopping search at depth " << depth << ".\n";
+                if (debug && depth < maxDepth)
+                    std::cout << "Search limit reached. Stopping search at depth " << depth << ".\n";
                 break;
             }
         }
 
-        double totalTime = std::chrono::duration<double>(
-                               std::chrono::high_resolution_clock::now() - startTime)
-                               .count();
+        searchStopped = true;
+        for (auto &helper : helpers)
+            pool.wait(helper);
+
+        double totalTime = timer.elapsed();
+        uint64_t nodeCount = totalNodes();
+        uint64_t leafNodeCount = totalLeafNodes();
         double nps = nodeCount / totalTime;
         double lnps = leafNodeCount / totalTime;
         if (debug)
@@ -154,10 +171,10 @@ namespace coredump
             std::cout << "Nodes Per Second (NPS): " << nps << "\n";
             std::cout << "Leaf Nodes Evaluated: " << leafNodeCount << "\n";
             std::cout << "Leaf Nodes Per Second (LNPS): " << lnps << "\n";
-            std::cout << "Final Best Move: " << bestMoveSoFar.fromSquare << " -> "
-                      << bestMoveSoFar.toSquare << " (Score: " << result->score << ")\n";
+            std::cout << "Final Best Move: " << bestMoveSoFar.from() << " -> "
+                      << bestMoveSoFar.to() << " (Score: " << bestScore << ")\n";
             std::cout << "============================\n";
         }
-        return bestMoveSoFar;
+        return position.toMove(bestMoveSoFar);
     }
 }
\ No newline at end of file
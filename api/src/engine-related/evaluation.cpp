@@ -1,168 +1,191 @@
 #include "engine-related/evaluation.h"
+
+#include <algorithm>
+#include "move/movegen.h"
+#include "move/referencePositions.h"
+
 namespace coredump
 {
+    template <Color Us>
+    int evaluatePosition(const Position &pos)
+    {
+        // Material and PST arrive summed from makeMove, so only the midgame/endgame taper is left to do
+        const PieceScores &scores = pos.scores;
+        const int phase = std::min(scores.phase, MAX_PHASE);
+        const int score = (scores.midgame * phase + scores.endgame * (MAX_PHASE - phase)) / MAX_PHASE;
+        return (Us == Color::WHITE) ? score : -score;
+    }
+
+    template int evaluatePosition<Color::WHITE>(const Position &);
+    template int evaluatePosition<Color::BLACK>(const Position &);
+
     int evaluatePosition(const Position &pos, Color color)
     {
-        int score = 0;
+        return (color == Color::WHITE) ? evaluatePosition<Color::WHITE>(pos) : evaluatePosition<Color::BLACK>(pos);
+    }
 
-        uint64_t pieces;
-        int square;
-        if (color == Color::WHITE)
+    // Takes the least valuable piece of color out of attackers and occupied, and adds any slider that was
+    // standing behind it on the line to square. Returns its type, or NONE if color has no attacker left
+    static PieceType popLeastValuable(const Position &pos, int square, Color color, uint64_t &attackers, uint64_t &occupied)
+    {
+        const uint64_t own = attackers & pos.pieces(color);
+        for (PieceType type : {PieceType::PAWN, PieceType::KNIGHT, PieceType::BISHOP, PieceType::ROOK, PieceType::QUEEN, PieceType::KING})
         {
-            pieces = pos.whitePawns;
-            while (pieces)
-            {
-                square = popLSB(pieces);
-                score += PAWN_VALUE + PAWN_PST[square];
-            }
-            pieces = pos.whiteKnights;
-            while (pieces)
-            {
-                square = popLSB(pieces);
-                score += KNIGHT_VALUE + KNIGHT_PST[square];
-            }
-            pieces = pos.whiteBishops;
-            while (pieces)
-            {
-                square = popLSB(pieces);
-                score += BISHOP_VALUE + BISHOP_PST[square];
-            }
-            pieces = pos.whiteRooks;
-            while (pieces)
-            {
-                square = popLSB(pieces);
-                score += ROOK_VALUE + ROOK_PST[square];
-            }
-            pieces = pos.whiteQueens;
-            while (pieces)
-            {
-                square = popLSB(pieces);
-                score += QUEEN_VALUE + QUEEN_PST[square];
-            }
-            pieces = pos.whiteKing;
-            while (pieces)
-            {
-                square = popLSB(pieces);
-                score += KING_PST[square];
-            }
+            const uint64_t candidates = own & pos.pieces(type);
+            if (!candidates)
+                continue;
+            occupied ^= candidates & (0 - candidates);
+            // Only a piece that attacks along a line can uncover a slider behind it
+            if (type == PieceType::PAWN || type == PieceType::BISHOP || type == PieceType::QUEEN)
+                attackers |= getBishopMoves(square, occupied) & pos.pieces(PieceType::BISHOP, PieceType::QUEEN);
+            if (type == PieceType::ROOK || type == PieceType::QUEEN)
+                attackers |= getRookMoves(square, occupied) & pos.pieces(PieceType::ROOK, PieceType::QUEEN);
+            attackers &= occupied;
+            return type;
+        }
+        return PieceType::NONE;
+    }
 
-            pieces = pos.blackPawns;
-            while (pieces)
-            {
-                square = popLSB(pieces);
-                score -= PAWN_VALUE + PAWN_PST[mirror(square)];
-            }
-            pieces = pos.blackKnights;
-            while (pieces)
-            {
-                square = popLSB(pieces);
-                score -= KNIGHT_VALUE + KNIGHT_PST[mirror(square)];
-            }
-            pieces = pos.blackBishops;
-            while (pieces)
-            {
-                square = popLSB(pieces);
-                score -= BISHOP_VALUE + BISHOP_PST[mirror(square)];
-            }
-            pieces = pos.blackRooks;
-            while (pieces)
-            {
-                square = popLSB(pieces);
-                score -= ROOK_VALUE + ROOK_PST[mirror(square)];
-            }
-            pieces = pos.blackQueens;
-            while (pieces)
-            {
-                square = popLSB(pieces);
-                score -= QUEEN_VALUE + QUEEN_PST[mirror(square)];
-            }
-            pieces = pos.blackKing;
-            while (pieces)
-            {
-                square = popLSB(pieces);
-                score -= KING_PST[mirror(square)];
-            }
-        } else {
-            pieces = pos.blackPawns;
-            while (pieces)
-            {
-                square = popLSB(pieces);
-                score += PAWN_VALUE + PAWN_PST[square];
-            }
-            pieces = pos.blackKnights;
-            while (pieces)
-            {
-                square = popLSB(pieces);
-                score += KNIGHT_VALUE + KNIGHT_PST[square];
-            }
-            pieces = pos.blackBishops;
-            while (pieces)
-            {
-                square = popLSB(pieces);
-                score += BISHOP_VALUE + BISHOP_PST[square];
-            }
-            pieces = pos.blackRooks;
-            while (pieces)
-            {
-                square = popLSB(pieces);
-                score += ROOK_VALUE + ROOK_PST[square];
-            }
-            pieces = pos.blackQueens;
-            while (pieces)
-            {
-                square = popLSB(pieces);
-                score += QUEEN_VALUE + QUEEN_PST[square];
-            }
-            pieces = pos.blackKing;
-            while (pieces)
-            {
-                square = popLSB(pieces);
-                score += KING_PST[square];
-            }
+    // Board after move's piece has left its square (and an en passant victim is gone), with the attackers
+    // of the target square on it. Returns the side making the move
+    static Color exchangeStart(const Position &pos, PackedMove move, uint64_t &attackers, uint64_t &occupied)
+    {
+        const Color us = (pos.pieceIndexOn(move.from()) >= 6) ? Color::BLACK : Color::WHITE;
+        occupied = pos.getOccupiedSquares() ^ (1ULL << move.from());
+        if (move.isEnPassant())
+            occupied ^= 1ULL << ((us == Color::WHITE) ? move.to() - 8 : move.to() + 8);
+        attackers = attackersTo(move.to(), occupied, pos) & occupied;
+        return us;
+    }
 
-            pieces = pos.whitePawns;
-            while (pieces)
-            {
-                square = popLSB(pieces);
-                score -= PAWN_VALUE + PAWN_PST[mirror(square)];
-            }
-            pieces = pos.whiteKnights;
-            while (pieces)
-            {
-                square = popLSB(pieces);
-                score -= KNIGHT_VALUE + KNIGHT_PST[mirror(square)];
-            }
-            pieces = pos.whiteBishops;
-            while (pieces)
-            {
-                square = popLSB(pieces);
-                score -= BISHOP_VALUE + BISHOP_PST[mirror(square)];
-            }
-            pieces = pos.whiteRooks;
-            while (pieces)
-            {
-                square = popLSB(pieces);
-                score -= ROOK_VALUE + ROOK_PST[mirror(square)];
-            }
-            pieces = pos.whiteQueens;
-            while (pieces)
-            {
-                square = popLSB(pieces);
-                score -= QUEEN_VALUE + QUEEN_PST[mirror(square)];
-            }
-            pieces = pos.whiteKing;
-            while (pieces)
-            {
-                square = popLSB(pieces);
-                score -= KING_PST[mirror(square)];
-            }
+    // What the side making move wins outright, and the piece left standing on the target square
+    static int initialGain(const Position &pos, PackedMove move, PieceType &onSquare)
+    {
+        int gain = getPieceValue(pos.capturedPieceType(move));
+        onSquare = pos.movedPieceType(move);
+        if (move.isPromotion())
+        {
+            onSquare = move.promotionPiece();
+            gain += getPieceValue(onSquare) - PAWN_VALUE;
+        }
+        return gain;
+    }
+
+    int staticExchange(const Position &pos, PackedMove move)
+    {
+        if (move.isCastling())
+            return 0;
+
+        uint64_t attackers, occupied;
+        Color side = exchangeStart(pos, move, attackers, occupied);
+        PieceType onSquare;
+        // gain[d]: material for the side making capture d, if the exchange stopped right after it
+        int gain[34];
+        int depth = 0;
+        gain[0] = initialGain(pos, move, onSquare);
+
+        while (true)
+        {
+            side = invertColor(side);
+            depth++;
+            gain[depth] = getPieceValue(onSquare) - gain[depth - 1]; // If side recaptures
+            PieceType attacker = popLeastValuable(pos, move.to(), side, attackers, occupied);
+            if (attacker == PieceType::NONE)
+                break;
+            if (attacker == PieceType::KING && (attackers & pos.pieces(invertColor(side))))
+                break; // The king can't capture onto a square that is still defended
+            onSquare = attacker;
         }
 
-        return score;
+        // The last entry was never played. Fold back: each side takes the better of stopping and recapturing
+        while (--depth)
+            gain[depth - 1] = -std::max(-gain[depth - 1], gain[depth]);
+        return gain[0];
     }
 
-    constexpr int mirror(int square)
+    bool seeGe(const Position &pos, PackedMove move, int threshold)
     {
-        return square ^ 56;
+        if (move.isCastling())
+            return 0 >= threshold;
+
+        PieceType onSquare;
+        // swap: how far above the threshold we are if the opponent stops now (or below it after they recapture)
+        int swap = initialGain(pos, move, onSquare) - threshold;
+        if (swap < 0)
+            return false; // Losing even if nothing recaptures
+        swap = getPieceValue(onSquare) - swap;
+        if (swap <= 0)
+            return true; // Winning even if the moved piece is lost
+
+        uint64_t attackers, occupied;
+        Color side = exchangeStart(pos, move, attackers, occupied);
+        int result = 1; // 1 while the side that moved is at or above the threshold
+
+        while (true)
+        {
+            side = invertColor(side);
+            if (!(attackers & pos.pieces(side)))
+                break;
+            result ^= 1;
+            PieceType attacker = popLeastValuable(pos, move.to(), side, attackers, occupied);
+            if (attacker == PieceType::KING)
+                return (attackers & pos.pieces(invertColor(side))) ? result ^ 1 : result;
+            swap = getPieceValue(attacker) - swap;
+            if (swap < result)
+                break;
+        }
+        return result;
+    }
+
+    // Exchanges with a known outcome: a rook winning an undefended pawn, and a knight taking a pawn that is
+    // defended more often than it is attacked once the x-rays join in (values from the chessprogramming wiki)
+    struct ExchangeCase
+    {
+        const char *fen;
+        const char *move;
+        int expected;
+    };
+    static const ExchangeCase EXCHANGE_CASES[] = {
+        {"1k1r4/1pp4p/p7/4p3/8/P5P1/1PP4P/2K1R3 w - - 0 1", "e1e5", 100},
+        {"1k1r3q/1ppn3p/p4b2/4p3/8/P2N2P1/1PP1R1BP/2K1Q3 w - - 0 1", "d3e5", -200},
+    };
+
+    bool runExchangeCheck(std::ostream &out, int depth)
+    {
+        bool passed = true;
+        for (const ExchangeCase &test : EXCHANGE_CASES)
+        {
+            Position pos(test.fen);
+            for (PackedMove move : generateMoves(pos, pos.sideToMove))
+            {
+                if (moveToString(move) != test.move)
+                    continue;
+                const int value = staticExchange(pos, move);
+                out << test.move << " " << value << " (expected " << test.expected << ")\n";
+                passed = passed && value == test.expected;
+            }
+        }
+
+        uint64_t captures = 0, mismatches = 0;
+        visitReferencePositions(depth, [&](const Position &pos)
+                                {
+            for (PackedMove move : generateMoves(pos, pos.sideToMove, GenType::CAPTURES))
+            {
+                const int value = staticExchange(pos, move);
+                captures++;
+                for (int threshold = -1000; threshold <= 1000; threshold += 25)
+                {
+                    if (seeGe(pos, move, threshold) != (value >= threshold))
+                    {
+                        mismatches++;
+                        break;
+                    }
+                }
+            } });
+
+        passed = passed && !mismatches;
+        out << "Captures " << captures << " | seeGe != staticExchange " << mismatches << "\n"
+            << (passed ? "Every exchange agrees" : "EXCHANGE MISMATCH") << "\n";
+        return passed;
     }
-}
\ No newline at end of file
+}
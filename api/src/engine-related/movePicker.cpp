@@ -0,0 +1,214 @@
+#include "engine-related/movePicker.h"
+
+namespace coredump
+{
+    // Swaps the highest scored move in [current, size) into current and returns it (partial selection sort)
+    static PackedMove pickBest(MoveList &moves, int *scores, size_t current)
+    {
+        size_t best = current;
+        for (size_t i = current + 1; i < moves.size(); i++)
+        {
+            if (scores[i] > scores[best])
+                best = i;
+        }
+        std::swap(moves[current], moves[best]);
+        std::swap(scores[current], scores[best]);
+        return moves[current];
+    }
+
+    // MVV-LVA, with the promoted piece counted as extra material
+    static int captureOrder(const Position &pos, PackedMove move)
+    {
+        int score = 100 * getPieceValue(pos.capturedPieceType(move)) - getPieceValue(pos.movedPieceType(move));
+        if (move.isPromotion())
+            score += 100 * getPieceValue(move.promotionPiece());
+        return score;
+    }
+
+    MovePicker::MovePicker(const Position &pos, Color color, PackedMove ttMove, int ply, const SearchThread &thread)
+        : pos(pos), thread(&thread), color(color), ttMove(ttMove), capturesOnly(false), quietChecks(false), evasions(false), stage(Stage::TT_MOVE),
+          capturesGenerated(false), quietsGenerated(false), current(0), killerIndex(0)
+    {
+        bool hasKillers = 0 <= ply && ply < MAX_PLY;
+        killers[0] = hasKillers ? thread.killers[ply][0] : PackedMove();
+        killers[1] = hasKillers ? thread.killers[ply][1] : PackedMove();
+    }
+
+    MovePicker::MovePicker(const Position &pos, Color color, PackedMove ttMove, bool quietChecks)
+        : pos(pos), thread(nullptr), color(color), ttMove(ttMove), capturesOnly(true), quietChecks(quietChecks), evasions(false), stage(Stage::TT_MOVE),
+          capturesGenerated(false), quietsGenerated(false), current(0), killerIndex(0)
+    {
+        killers[0] = killers[1] = PackedMove();
+    }
+
+    MovePicker::MovePicker(const Position &pos, Color color, PackedMove ttMove, const SearchThread &thread)
+        : pos(pos), thread(&thread), color(color), ttMove(ttMove), capturesOnly(false), quietChecks(false), evasions(true), stage(Stage::TT_MOVE),
+          capturesGenerated(false), quietsGenerated(false), current(0), killerIndex(0)
+    {
+        killers[0] = killers[1] = PackedMove();
+    }
+
+    void MovePicker::generateCaptureList()
+    {
+        if (capturesGenerated)
+            return;
+        captures = generateMoves(pos, color, GenType::CAPTURES);
+        capturesGenerated = true;
+    }
+
+    void MovePicker::generateQuietList()
+    {
+        if (quietsGenerated)
+            return;
+        quiets = generateMoves(pos, color, GenType::QUIETS);
+        quietsGenerated = true;
+    }
+
+    // Moves already handed out by the TT or killer stages, which later stages must not repeat
+    bool MovePicker::isPreviouslyPicked(PackedMove move) const
+    {
+        return move == ttMove || (stage == Stage::QUIETS && (move == killers[0] || move == killers[1]));
+    }
+
+    PackedMove MovePicker::nextMove()
+    {
+        while (true)
+        {
+            switch (stage)
+            {
+            case Stage::TT_MOVE:
+            {
+                stage = evasions ? Stage::GENERATE_EVASIONS : Stage::GENERATE_CAPTURES;
+                // The TT move may come from a hash collision, so it is validated on the board before any generation
+                if (!ttMove.isNone() && isLegal(pos, color, ttMove) &&
+                    (!capturesOnly || pos.isCapture(ttMove) || ttMove.isPromotion()))
+                    return ttMove;
+                ttMove = PackedMove(); // Unusable, so nothing to skip later
+                break;
+            }
+
+            case Stage::GENERATE_CAPTURES:
+                generateCaptureList();
+                for (size_t i = 0; i < captures.size(); i++)
+                    captureScores[i] = captureOrder(pos, captures[i]);
+                current = 0;
+                stage = Stage::GOOD_CAPTURES;
+                break;
+
+            case Stage::GOOD_CAPTURES:
+                while (current < captures.size())
+                {
+                    PackedMove move = pickBest(captures, captureScores, current++);
+                    if (isPreviouslyPicked(move))
+                        continue;
+                    // Captures that lose material in the exchange (by SEE) wait until after the quiets
+                    if (move.isPromotion() || seeGe(pos, move, 0))
+                        return move;
+                    badCaptures.push_back(move);
+                }
+                stage = !capturesOnly ? Stage::KILLERS : quietChecks ? Stage::GENERATE_QUIET_CHECKS : Stage::DONE;
+                break;
+
+            case Stage::KILLERS:
+                // Killers come from sibling nodes, so each one is checked on this board; only quiet ones are tried here
+                while (killerIndex < 2)
+                {
+                    PackedMove killer = killers[killerIndex++];
+                    if (killer.isNone() || killer == ttMove || (killerIndex == 2 && killer == killers[0]))
+                        continue;
+                    if (!pos.isCapture(killer) && !killer.isPromotion() && isLegal(pos, color, killer))
+                        return killer;
+                }
+                stage = Stage::GENERATE_QUIETS;
+                break;
+
+            case Stage::GENERATE_QUIETS:
+            {
+                generateQuietList();
+                for (size_t i = 0; i < quiets.size(); i++)
+                    quietScores[i] = thread->historyScore(quiets[i], color);
+                current = 0;
+                stage = Stage::QUIETS;
+                break;
+            }
+
+            case Stage::QUIETS:
+                while (current < quiets.size())
+                {
+                    PackedMove move = pickBest(quiets, quietScores, current++);
+                    if (!isPreviouslyPicked(move))
+                        return move;
+                }
+                // The capture list is finished with, so its score array takes the exchange values
+                for (size_t i = 0; i < badCaptures.size(); i++)
+                    captureScores[i] = staticExchange(pos, badCaptures[i]);
+                current = 0;
+                stage = Stage::BAD_CAPTURES;
+                break;
+
+            case Stage::BAD_CAPTURES:
+                // Smallest loss first
+                if (current < badCaptures.size())
+                    return pickBest(badCaptures, captureScores, current++);
+                stage = Stage::DONE;
+                break;
+
+            case Stage::GENERATE_QUIET_CHECKS:
+                // Unscored: there are few of them and the search looks at every one
+                quiets = generateMoves(pos, color, GenType::QUIET_CHECKS);
+                current = 0;
+                stage = Stage::QUIET_CHECKS;
+                break;
+
+            case Stage::QUIET_CHECKS:
+                while (current < quiets.size())
+                {
+                    PackedMove move = quiets[current++];
+                    if (!isPreviouslyPicked(move))
+                        return move;
+                }
+                stage = Stage::DONE;
+                break;
+
+            case Stage::GENERATE_EVASIONS:
+            {
+                // One generation, split so the captures can be picked by MVV-LVA ahead of the quiets by history.
+                // No SEE here: with the king attacked, a losing capture may still be the only answer
+                const MoveList moves = generateMoves(pos, color, GenType::EVASIONS);
+                for (size_t i = 0; i < moves.size(); i++)
+                {
+                    PackedMove move = moves[i];
+                    if (pos.isCapture(move) || move.isPromotion())
+                    {
+                        captureScores[captures.size()] = captureOrder(pos, move);
+                        captures.push_back(move);
+                    }
+                    else
+                    {
+                        quietScores[quiets.size()] = thread->historyScore(move, color);
+                        quiets.push_back(move);
+                    }
+                }
+                current = 0;
+                stage = Stage::EVASIONS;
+                break;
+            }
+
+            case Stage::EVASIONS:
+                while (current < captures.size() + quiets.size())
+                {
+                    PackedMove move = (current < captures.size()) ? pickBest(captures, captureScores, current)
+                                                                  : pickBest(quiets, quietScores, current - captures.size());
+                    current++;
+                    if (!isPreviouslyPicked(move))
+                        return move;
+                }
+                stage = Stage::DONE;
+                break;
+
+            case Stage::DONE:
+                return PackedMove();
+            }
+        }
+    }
+}
@@ -2,56 +2,57 @@
 
 namespace coredump
 {
-    // Sort moves from
-    int sortMoves(std::vector<Move> &moves, const Position &pos, int ply, Color color)
+    // Sort moves from most to least promising
+    // Each move is scored once up front (a PackedMove carries no piece info, so scoring reads the board)
+    int sortMoves(MoveList &moves, const Position &pos, int ply, Color color, const SearchThread *thread)
     {
-        std::sort(moves.begin(), moves.end(), [&](const Move &a, const Move &b)
-                  {
-                      int scoreA = 0, scoreB = 0;
-
-                      // Fetch TT best move
-                      TTEntry *tt = probeTT(pos.computeHash(), 0, -INT_MAX, INT_MAX);
-                      const Move ttBestMove = (tt ? tt->bestMove : Move());
-
-                      // Prioritize TT Move
-                      if (a == ttBestMove)
-                          scoreA += 10000;
-                      if (b == ttBestMove)
-                          scoreB += 10000;
-
-                      // Killer Moves
-                      if (a == killerMoves[ply][0])
-                          scoreA += 9000;
-                      if (b == killerMoves[ply][0])
-                          scoreB += 9000;
-                      if (a == killerMoves[ply][1])
-                          scoreA += 8000;
-                      if (b == killerMoves[ply][1])
-                          scoreB += 8000;
-
-                      // History Heuristic
-                      // Ensure valid move indices before accessing the array
-                      int colorIndex = (color == Color::WHITE) ? 0 : 1;
-
-                      if (colorIndex >= 0 && colorIndex < 2 &&
-                          a.fromSquare >= 0 && a.fromSquare < 64 &&
-                          a.toSquare >= 0 && a.toSquare < 64 &&
-                          b.fromSquare >= 0 && b.fromSquare < 64 &&
-                          b.toSquare >= 0 && b.toSquare < 64)
-                      {
-
-                          scoreA += historyHeuristic[colorIndex][a.fromSquare][a.toSquare];
-                          scoreB += historyHeuristic[colorIndex][b.fromSquare][b.toSquare];
-                      }
-
-                      // MVV-LVA for captures
-                      if (a.isCapture)
-                          scoreA += 100 * getPieceValue(a.capturedPieceType) - getPieceValue(a.pieceType);
-                      if (b.isCapture)
-                          scoreB += 100 * getPieceValue(b.capturedPieceType) - getPieceValue(b.pieceType);
-
-                      return scoreA > scoreB; // Higher score first
-                  });
+        // Fetch TT best move
+        TTEntry tt;
+        const PackedMove ttBestMove = probeTT(pos.hash, tt) ? tt.bestMove : PackedMove();
+        const bool hasKillers = thread && 0 <= ply && ply < MAX_PLY;
+
+        int scores[MAX_MOVES];
+        for (size_t i = 0; i < moves.size(); i++)
+        {
+            const PackedMove move = moves[i];
+            int score = 0;
+
+            // Prioritize TT Move
+            if (!ttBestMove.isNone() && move == ttBestMove)
+                score += 10000;
+
+            // Killer Moves
+            if (hasKillers && move == thread->killers[ply][0])
+                score += 9000;
+            if (hasKillers && move == thread->killers[ply][1])
+                score += 8000;
+
+            // History Heuristic
+            if (thread)
+                score += thread->historyScore(move, color);
+
+            // MVV-LVA for captures
+            if (pos.isCapture(move))
+                score += 100 * getPieceValue(pos.capturedPieceType(move)) - getPieceValue(pos.movedPieceType(move));
+
+            scores[i] = score;
+        }
+
+        // Insertion sort, higher score first; lists are short and often nearly sorted already
+        for (size_t i = 1; i < moves.size(); i++)
+        {
+            const PackedMove move = moves[i];
+            const int score = scores[i];
+            size_t j = i;
+            while (j > 0 && scores[j - 1] < score)
+            {
+                moves[j] = moves[j - 1];
+                scores[j] = scores[j - 1];
+                j--;
+            }
+            moves[j] = move;
+            scores[j] = score;
+        }
 
         return 0;
     }
@@ -1,225 +1,366 @@
 #include "engine-related/search.h"
 
+#include <optional>
+
 namespace coredump
 {
+    // Mate scores are stored relative to the node rather than the root, so a TT hit at another ply
+    // still reports the right distance to mate
+    static int scoreToTT(int score, int ply)
+    {
+        return (score >= MATE_BOUND) ? score + ply : (score <= -MATE_BOUND) ? score - ply : score;
+    }
 
-    // New algorithm: Minimax w/ AB pruning. Used for debugging and testing (not to mention the fact that it doesn't sound like a slur.)
-    // Added 4/5/25
-    int minimax(std::chrono::high_resolution_clock::time_point startTime, double timeLimit,
-        const Position &pos, int depth, int alpha, int beta, Color maximizingColor, Color currentColor, int ply) {
-        // Terminal node flags
-        bool noMovesMax = generateMoves(pos, maximizingColor).size() == 0;
-        bool noMovesMin = generateMoves(pos, maximizingColor == Color::WHITE ? Color::BLACK : Color::WHITE).size() == 0;
-        bool isCheckMax = isInCheck(pos, maximizingColor);
-        bool isCheckMin = isInCheck(pos, maximizingColor == Color::WHITE ? Color::BLACK : Color::WHITE);
-        
-        // Derived terminal node flags
-        bool maxLoss = noMovesMax && isCheckMax;
-        bool minLoss = noMovesMin && isCheckMin;
-        bool stalemate = noMovesMax && noMovesMin && !isCheckMax && !isCheckMin;
-
-        // Base case: Quiescence Search at Depth 0
-        if (depth == 0) {
-            return quiescenceSearch(pos, alpha, beta, maximizingColor, ply); // Depth reached; return evaluation
-        }
+    static int scoreFromTT(int score, int ply)
+    {
+        return (score >= MATE_BOUND) ? score - ply : (score <= -MATE_BOUND) ? score + ply : score;
+    }
 
-        // Base case: Checkmate / Stalemate Detection
-        if (maxLoss) {
-            return -KING_VALUE; // Punish conceding checkmate
-        }
+    // ! This function is where the magic happens. Optimizing its speed is of upmost importance.
+    // Negamax principal variation search with Alpha-Beta Pruning
+    int negamax(const Position &pos, int depth, int alpha, int beta, Color color, int ply,
+                TimeManager &timer, SearchThread &thread)
+    {
+        SearchStackEntry &node = thread.stack[ply];
+        node.pv.length = 0;
 
-        if (minLoss) {
-            return KING_VALUE; // Reward checkmate
+        // Base Case: Quiescence Search at Depth 0 (which counts the node itself)
+        if (depth <= 0 || ply >= MAX_PLY)
+        {
+            thread.leafNodeCount.store(thread.leafNodeCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return quiescenceSearch(pos, alpha, beta, color, ply, QS_DEPTH_CHECKS, timer, thread);
         }
 
-        if (stalemate) {
-            return 0; // Stalemate is a draw; do not reward or punish
+        // Only this thread writes its counter, so a plain load and store is enough (no locked add)
+        const uint64_t nodes = thread.nodeCount.load(std::memory_order_relaxed) + 1;
+        thread.nodeCount.store(nodes, std::memory_order_relaxed);
+        if (thread.id == 0)
+            timer.poll(nodes);
+        if (searchStopped.load(std::memory_order_relaxed))
+            return 0; // Thrown away by the caller
+        const int originalAlpha = alpha;
+        // Only PV nodes have an open window; everything else is a null-window scout
+        const bool pvNode = beta - alpha > 1;
+
+        // Transposition Table Lookup. PV nodes never cut on it, so the principal variation stays whole
+        TTEntry ttEntry;
+        const bool ttHit = probeTT(pos.hash, ttEntry);
+        const PackedMove ttMove = ttHit ? ttEntry.bestMove : PackedMove();
+        if (ttHit && !pvNode && ttEntry.depth >= depth)
+        {
+            const int ttScore = scoreFromTT(ttEntry.score, ply);
+            if (ttEntry.flag == EXACT)
+                return ttScore;
+            if (ttEntry.flag == LOWERBOUND && ttScore >= beta)
+                return ttScore;
+            if (ttEntry.flag == UPPERBOUND && ttScore <= alpha)
+                return ttScore;
         }
 
-        if (maximizingColor == currentColor) { // Maximize
-            int bestScore = -INT_MAX;
-            std::vector<Move> moves = generateMoves(pos, maximizingColor);
-            sortMoves(moves, pos, ply, currentColor); // Best move ordering
+        // Checkers are cached on the position, so this is the only attack scan the node pays for
+        const bool inCheck = isInCheck(pos, color);
+        // Futility pruning compares every quiet move against the same static evaluation
+        const bool canPruneFutile = depth <= 3 && !inCheck && !pvNode;
+        node.staticEval = inCheck ? -INFINITE_SCORE : evaluatePosition(pos, color); // O(1) with the incremental scores
+        const int staticEval = node.staticEval;
 
-            //Search
-            for (const Move &move : moves) {
-                Position tempPos(pos, move);
-
-                auto elapsedTime = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTime).count();
-                if (elapsedTime >= timeLimit) {
-                    return std::max(bestScore, evaluatePosition(tempPos, maximizingColor));
-                }
-
-                int score = minimax(startTime, timeLimit, tempPos, depth - 1, alpha, beta,
-                    maximizingColor, currentColor == Color::WHITE ? Color::BLACK : Color::WHITE, ply + 1);
+        // **Null Move Pruning** (pass the turn; if that still beats beta, a real move will too)
+        // Skipped with only pawns left, where passing can hide a zugzwang
+        if (!pvNode && depth >= 3 && !inCheck && (pos.pieces(color) & ~pos.pieces(PieceType::PAWN, PieceType::KING)))
+        {
+            Position nullPos(pos);
+            nullPos.makeNullMove();
+            node.currentMove = PackedMove();
+            int score = -negamax(nullPos, depth - 3, -beta, -beta + 1, invertColor(color), ply + 1, timer, thread);
+            if (searchStopped.load(std::memory_order_relaxed))
+                return 0;
+            if (score >= beta)
+                return score >= MATE_BOUND ? beta : score; // A mate found after passing proves nothing
+        }
 
-                bestScore = std::max(bestScore, score);
+        int bestScore = -INFINITE_SCORE;
+        PackedMove bestMove;
+        const PVLine &childLine = thread.stack[ply + 1].pv;
 
-                alpha = std::max(alpha, score);
+        // Moves arrive best first and are only generated as far as the search gets
+        MovePicker picker(pos, color, ttMove, ply, thread);
+        size_t moveCount = 0;
+        for (PackedMove move = picker.nextMove(); !move.isNone(); move = picker.nextMove())
+        {
+            if (move == node.excludedMove)
+                continue;
+            const size_t i = moveCount++;
+            const bool isCapture = pos.isCapture(move);
+            const bool isCheck = givesCheck(pos, move);
+            const bool isQuiet = !isCapture && !move.isPromotion();
 
-                if (beta <= alpha) {
-                    break; // Beta cutoff
-                }
+            //  **Futility Pruning** (Skip obviously bad moves, but never a check or the first move)
+            if (canPruneFutile && i > 0 && isQuiet && !isCheck && staticEval + 200 <= alpha)
+            {
+                continue;
             }
 
-            return bestScore;
-        } else { // Minimize
-            int bestScore = INT_MAX;
-            std::vector<Move> moves = generateMoves(pos, currentColor);
-            sortMoves(moves, pos, ply, currentColor); // Best move ordering
-
-            // Search
-            for (const Move &move : moves) {
-                Position tempPos(pos, move);
-
-                auto elapsedTime = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTime).count();
-                if (elapsedTime >= timeLimit) {
-                    return std::min(bestScore, evaluatePosition(tempPos, currentColor));
-                }
+            // Copy-make: the parent is never modified, so it keeps its cached attack info for givesCheck
+            // and the move picker across the whole move loop
+            Position child(pos);
+            StateInfo state;
+            child.makeMove(move, state);
+            prefetchTT(child.hash); // The child probes its bucket first thing; start the load now
+            node.currentMove = move;
+            const Color otherColor = invertColor(color);
+            int score;
+            if (i == 0)
+            {
+                // First move (the TT or best-ordered move) is searched with the full window
+                score = -negamax(child, depth - 1, -beta, -alpha, otherColor, ply + 1, timer, thread);
+            }
+            else
+            {
+                //  **Late Move Reductions (LMR)**, gentler along the principal variation
+                int reduction = 0;
+                if (i >= 4 && isQuiet && !isCheck && !inCheck && depth >= 3)
+                    reduction = pvNode ? 1 : std::min(2, depth / 2);
+
+                // Null-window scout: only proves whether the move beats alpha
+                score = -negamax(child, depth - 1 - reduction, -alpha - 1, -alpha, otherColor, ply + 1, timer, thread);
+                if (score > alpha && reduction)
+                    score = -negamax(child, depth - 1, -alpha - 1, -alpha, otherColor, ply + 1, timer, thread);
+                // It does: on a PV node, get its exact score with the full window
+                if (score > alpha && score < beta)
+                    score = -negamax(child, depth - 1, -beta, -alpha, otherColor, ply + 1, timer, thread);
+            }
 
-                int score = minimax(startTime, timeLimit, tempPos, depth - 1, alpha, beta,
-                    maximizingColor, currentColor == Color::WHITE ? Color::BLACK : Color::WHITE, ply + 1);
+            if (searchStopped.load(std::memory_order_relaxed))
+                return 0;
 
-                bestScore = std::min(bestScore, score);
+            if (score > bestScore)
+            {
+                bestScore = score;
+                bestMove = move;
+            }
 
-                beta = std::min(beta, score);
+            if (score > alpha)
+            {
+                alpha = score;
+                if (pvNode)
+                    node.pv.update(move, childLine);
+            }
 
-                if (beta <= alpha) {
-                    break; // Alpha cutoff
+            if (alpha >= beta)
+            {
+                // **Beta Cutoff: Store killer move & history heuristic**
+                if (isQuiet)
+                {
+                    thread.storeKillerMove(move, ply);
+                    thread.storeHistoryHeuristic(move, depth, color);
                 }
+                storeTT(pos.hash, depth, scoreToTT(bestScore, ply), move, LOWERBOUND);
+                return bestScore; // Prune (fail-soft)
             }
-
-            return bestScore;
         }
+
+        // Checkmate / Stalemate Detection (nearer mates score higher)
+        if (moveCount == 0)
+            return (inCheck ? -MATE_SCORE + ply : 0);
+
+        // Store result in Transposition Table
+        TTFlag flag = (bestScore > originalAlpha) ? EXACT : UPPERBOUND;
+        storeTT(pos.hash, depth, scoreToTT(bestScore, ply), bestMove, flag);
+        return bestScore;
     }
 
-    // ! This function is where the magic happens. Optimizing its speed is of upmost importance.
-    // Negamax with Alpha-Beta Pruning
-    int negamax(const Position &pos, int depth, int alpha, int beta, Color color, int ply,
-                std::chrono::high_resolution_clock::time_point startTime, double timeLimit, std::atomic<uint64_t> &nodeCount, std::atomic<uint64_t> &leafNodeCount)
+    // Search all capture moves that stem from this move
+    // "Please mom, just one more search! It'll only take a few milliseconds!"
+    int quiescenceSearch(const Position &pos, int alpha, int beta, Color color, int ply, int depth,
+                         TimeManager &timer, SearchThread &thread)
     {
-        Position tempPos(pos);
-        nodeCount++;
-        // Transposition Table Lookup
-        TTEntry *ttEntry = probeTT(pos.computeHash(), depth, alpha, beta);
-        if (ttEntry && ttEntry->depth >= depth)
+        const uint64_t nodes = thread.nodeCount.load(std::memory_order_relaxed) + 1;
+        thread.nodeCount.store(nodes, std::memory_order_relaxed);
+        if (thread.id == 0)
+            timer.poll(nodes);
+        if (searchStopped.load(std::memory_order_relaxed))
+            return 0; // Thrown away by the caller
+
+        const bool inCheck = isInCheck(pos, color);
+        if (ply >= MAX_PLY)
+            return inCheck ? 0 : evaluatePosition(pos, color);
+
+        const int originalAlpha = alpha;
+        const bool pvNode = beta - alpha > 1;
+        // Nodes that also try quiet checks have searched more, so they are stored one depth deeper
+        const bool searchChecks = depth >= QS_DEPTH_CHECKS && !inCheck;
+        const int ttDepth = searchChecks ? QS_DEPTH_CHECKS : QS_DEPTH_NO_CHECKS;
+
+        // Stand pat: the side to move can usually do at least as well as the static evaluation by
+        // not capturing. Not in check, where every evasion has to be searched
+        // Most quiescence nodes end right here, so this comes before the (cache missing) TT probe
+        int standPat = -INFINITE_SCORE;
+        if (!inCheck)
         {
-            if (ttEntry->flag == EXACT)
-                return ttEntry->score;
-            if (ttEntry->flag == LOWERBOUND && ttEntry->score >= beta)
-                return ttEntry->score;
-            if (ttEntry->flag == UPPERBOUND && ttEntry->score <= alpha)
-                return ttEntry->score;
+            standPat = evaluatePosition(pos, color);
+            if (standPat >= beta)
+                return standPat; // Beta cutoff
         }
 
-        // Base Case: Quiescence Search at Depth 0
-        if (depth == 0)
+        // Transposition Table Lookup. Any stored search of this node is at least as deep as this one
+        TTEntry ttEntry;
+        const bool ttHit = probeTT(pos.hash, ttEntry);
+        if (ttHit && !pvNode && ttEntry.depth >= ttDepth)
         {
-            return quiescenceSearch(pos, alpha, beta, color, ply);
+            const int ttScore = scoreFromTT(ttEntry.score, ply);
+            if (ttEntry.flag == EXACT ||
+                (ttEntry.flag == LOWERBOUND && ttScore >= beta) ||
+                (ttEntry.flag == UPPERBOUND && ttScore <= alpha))
+                return ttScore;
         }
+        const PackedMove ttMove = ttHit ? ttEntry.bestMove : PackedMove();
+
+        int bestScore = standPat;
+        alpha = std::max(alpha, standPat);
+
+        // In check: every evasion, captures first. Otherwise captures and promotions, best first
+        // (losing captures by SEE are never handed out), then quiet checks on the first ply
+        std::optional<MovePicker> picker;
+        if (inCheck)
+            picker.emplace(pos, color, ttMove, thread);
+        else
+            picker.emplace(pos, color, ttMove, searchChecks);
+
+        PackedMove bestMove;
+        int moveCount = 0;
+        for (PackedMove move = picker->nextMove(); !move.isNone(); move = picker->nextMove())
+        {
+            moveCount++;
+            if (!inCheck && !move.isPromotion())
+            {
+                if (!pos.isCapture(move))
+                {
+                    // A quiet check that just loses the piece is not worth following
+                    if (!seeGe(pos, move, 0))
+                        continue;
+                }
+                else
+                {
+                    // **Delta Pruning**: even winning the piece outright can't lift us back to alpha
+                    // Checking captures are kept; givesCheck is only paid for when the capture would be pruned
+                    const int optimistic = standPat + getPieceValue(pos.capturedPieceType(move)) + QS_DELTA_MARGIN;
+                    if (optimistic <= alpha && !givesCheck(pos, move))
+                    {
+                        bestScore = std::max(bestScore, optimistic);
+                        continue;
+                    }
+                }
+            }
 
-        std::vector<Move> moves = generateMoves(pos, color);
-        sortMoves(moves, pos, ply, color); // Best move ordering
-
-        // Checkmate / Stalemate Detection
-        if (moves.empty())
-            return (isInCheck(pos, color) ? -KING_VALUE : 0);
+            Position child(pos);
+            StateInfo state;
+            child.makeMove(move, state);
+            prefetchTT(child.hash);
+            int score = -quiescenceSearch(child, -beta, -alpha, invertColor(color), ply + 1, depth - 1, timer, thread);
+            if (searchStopped.load(std::memory_order_relaxed))
+                return 0;
 
-        // // **Null Move Pruning** (Skip losing positions)
-        if (depth >= 3 && !isInCheck(pos, color))
-        {
-            int score = -negamax(pos, depth - 3, -beta, -beta + 1, invertColor(color), ply + 1, startTime, timeLimit, nodeCount, leafNodeCount);
+            if (score > bestScore)
+            {
+                bestScore = score;
+                bestMove = move;
+            }
             if (score >= beta)
-                return beta; // Beta cutoff (opponent is winning)
+            {
+                storeTT(pos.hash, ttDepth, scoreToTT(score, ply), move, LOWERBOUND);
+                return score; // Beta cutoff
+            }
+            alpha = std::max(alpha, score);
         }
 
-        int bestScore = -INT_MAX;
-        Move bestMove;
-        bool isPV = false; // Principal Variation (best line so far)
+        // No evasion at all: checkmate
+        if (inCheck && moveCount == 0)
+            return -MATE_SCORE + ply;
+
+        TTFlag flag = (pvNode && bestScore > originalAlpha) ? EXACT : UPPERBOUND;
+        storeTT(pos.hash, ttDepth, scoreToTT(bestScore, ply), bestMove, flag);
+        return bestScore;
+    }
+
+    int searchRoot(const Position &pos, MoveList &rootMoves, int depth, int alpha, int beta, Color color,
+                   TimeManager &timer, SearchThread &thread)
+    {
+        int bestScore = -INFINITE_SCORE;
+        size_t bestIndex = 0;
+        SearchStackEntry &root = thread.stack[0];
+        const PVLine &childLine = thread.stack[1].pv;
+        root.pv.length = 0;
 
-        for (size_t i = 0; i < moves.size(); i++)
+        for (size_t i = 0; i < rootMoves.size(); i++)
         {
-            auto elapsedTime = std::chrono::duration<double>(
-                                   std::chrono::high_resolution_clock::now() - startTime)
-                                   .count();
-            if (elapsedTime >= timeLimit)
-                return evaluatePosition(pos, color);
-            const Move &move = moves[i];
-
-            //  **Futility Pruning** (Skip obviously bad moves)
-            if (depth <= 3 && !move.isCapture && !isInCheck(pos, color) && evaluatePosition(pos, color) + 200 <= alpha)
+            Position child(pos);
+            StateInfo state;
+            child.makeMove(rootMoves[i], state);
+            root.currentMove = rootMoves[i];
+            const Color otherColor = invertColor(color);
+            int score;
+            if (i == 0)
             {
-                continue;
+                score = -negamax(child, depth - 1, -beta, -alpha, otherColor, 1, timer, thread);
             }
-
-            tempPos.makeMove(move);
-            int searchDepth = depth - 1;
-            //  **Late Move Reductions (LMR)**
-            if (!isPV && i >= 4 && !move.isCapture && depth >= 3)
+            else
             {
-                searchDepth -= std::min(2, depth / 2); // Reduce depth more aggressively
+                score = -negamax(child, depth - 1, -alpha - 1, -alpha, otherColor, 1, timer, thread);
+                if (score > alpha && score < beta)
+                    score = -negamax(child, depth - 1, -beta, -alpha, otherColor, 1, timer, thread);
             }
-            const Color otherColor = invertColor(color);
-            // Recursive call to this function but of the other color.
-            int score = -negamax(tempPos, searchDepth, -beta, -alpha, otherColor, ply + 1, startTime, timeLimit, nodeCount, leafNodeCount);
-            // One by one, we pop out of the recursive calls and undo each move back up the tree
-            tempPos.undoMove(move);
 
-            if (score >= beta)
-            {
-                // **Beta Cutoff: Store killer move & history heuristic**
-                //if (!move.isCapture)
-                //{
-                //    // SEG FAULT
-                //    storeKillerMove(move, ply);
-                //    storeHistoryHeuristic(move, depth, color);
-                //}
-                return beta; // Prune
-            }
+            if (searchStopped.load(std::memory_order_relaxed))
+                break; // Score of an interrupted search can't be trusted
 
             if (score > bestScore)
             {
                 bestScore = score;
-                bestMove = move;
-                isPV = true; // Mark as Principal Variation
+                bestIndex = i;
+                root.pv.update(rootMoves[i], childLine);
             }
-
             alpha = std::max(alpha, score);
+            if (alpha >= beta)
+                break; // Fail high; the aspiration window is widened and the root searched again
         }
 
-        // Store result in Transposition Table
-        TTFlag flag = (bestScore <= alpha) ? UPPERBOUND : ((bestScore >= beta) ? LOWERBOUND : EXACT);
-        storeTT(pos.computeHash(), depth, bestScore, bestMove, flag);
+        std::rotate(rootMoves.begin(), rootMoves.begin() + bestIndex, rootMoves.begin() + bestIndex + 1);
         return bestScore;
     }
 
-    // Search all capture moves that stem from this move
-    // "Please mom, just one more search! It'll only take a few milliseconds!"
-    int quiescenceSearch(const Position &pos, int alpha, int beta, Color color, int ply)
+    int aspirationSearch(const Position &pos, MoveList &rootMoves, int depth, int previousScore, Color color,
+                         TimeManager &timer, SearchThread &thread)
     {
-        int standPat = evaluatePosition(pos, color);
-        if (standPat >= beta)
-            return beta; // Beta cutoff
-        if (standPat > alpha)
-            alpha = standPat;
-
-        std::vector<Move> captures = generateCaptures(pos, color);
-        sortMoves(captures, pos, ply, color);
-
-        for (Move &move : captures)
+        // Shallow scores are too unstable to aim at, and mate scores jump between iterations
+        int delta = 25;
+        int alpha = -INFINITE_SCORE;
+        int beta = INFINITE_SCORE;
+        if (depth >= 4 && std::abs(previousScore) < MATE_BOUND)
         {
-            // Skip bad captures using SEE
-            if (!SEE(move))
-                continue;
+            alpha = previousScore - delta;
+            beta = previousScore + delta;
+        }
 
-            const Position tempPos(pos, move);
-            int score = -quiescenceSearch(tempPos, -beta, -alpha, invertColor(color), ply + 1);
+        while (true)
+        {
+            int score = searchRoot(pos, rootMoves, depth, alpha, beta, color, timer, thread);
+            if (searchStopped.load(std::memory_order_relaxed))
+                return score;
 
-            if (score >= beta)
-                return beta; // Beta cutoff
-            alpha = std::max(alpha, score);
+            if (score <= alpha)
+            {
+                beta = (alpha + beta) / 2;
+                alpha = std::max(score - delta, -INFINITE_SCORE);
+            }
+            else if (score >= beta)
+            {
+                beta = std::min(score + delta, INFINITE_SCORE);
+            }
+            else
+            {
+                return score;
+            }
+            delta *= 2;
         }
-
-        return alpha;
     }
 }
@@ -0,0 +1,21 @@
+#include "engine-related/searchThread.h"
+
+#include <algorithm>
+
+namespace coredump
+{
+    void SearchThread::clear()
+    {
+        for (auto &plyKillers : killers)
+            plyKillers[0] = plyKillers[1] = PackedMove();
+        std::fill(&history[0][0][0], &history[0][0][0] + 2 * 64 * 64, 0);
+        for (SearchStackEntry &entry : stack)
+        {
+            entry.staticEval = 0;
+            entry.currentMove = entry.excludedMove = PackedMove();
+            entry.pv.length = 0;
+        }
+        nodeCount.store(0, std::memory_order_relaxed);
+        leafNodeCount.store(0, std::memory_order_relaxed);
+    }
+}
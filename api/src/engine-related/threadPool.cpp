@@ -0,0 +1,179 @@
+#include "engine-related/threadPool.h"
+
+#include <algorithm>
+
+namespace coredump
+{
+    // Which pool (and which of its workers) the current thread belongs to, if any
+    static thread_local const ThreadPool *currentPool = nullptr;
+    static thread_local int currentWorker = -1;
+
+    ThreadPool::ThreadPool(int threadCount) : statsStart(std::chrono::steady_clock::now())
+    {
+        threadCount = std::max(1, threadCount);
+        for (int i = 0; i < threadCount; i++)
+            workers.push_back(std::make_unique<Worker>());
+
+        // Start threads only once every deque exists, since workers steal from each other right away
+        for (int i = 0; i < threadCount; i++)
+            workers[i]->thread = std::thread(&ThreadPool::workerLoop, this, i);
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            stopping = true;
+        }
+        wakeUp.notify_all();
+        for (auto &worker : workers)
+            worker->thread.join();
+    }
+
+    void ThreadPool::enqueue(std::function<void()> task)
+    {
+        size_t queue = (currentPool == this) ? static_cast<size_t>(currentWorker)
+                                             : nextQueue.fetch_add(1, std::memory_order_relaxed) % workers.size();
+        {
+            std::lock_guard<std::mutex> lock(workers[queue]->mutex);
+            workers[queue]->tasks.push_back(std::move(task));
+        }
+        tasksSubmitted.fetch_add(1, std::memory_order_relaxed);
+
+        // Counted under the sleep mutex so a worker can't check for work and go to sleep in between
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            pendingTasks.fetch_add(1);
+        }
+        wakeUp.notify_one();
+    }
+
+    bool ThreadPool::popTask(int workerIndex, std::function<void()> &task)
+    {
+        int count = size();
+
+        // Own deque first, newest task first
+        if (workerIndex >= 0)
+        {
+            Worker &own = *workers[workerIndex];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.tasks.empty())
+            {
+                task = std::move(own.tasks.back());
+                own.tasks.pop_back();
+                pendingTasks.fetch_sub(1);
+                return true;
+            }
+        }
+
+        // Steal the oldest task from someone else, starting after ourselves so thieves spread out
+        int start = (workerIndex >= 0) ? workerIndex + 1 : 0;
+        for (int offset = 0; offset < count; offset++)
+        {
+            int victimIndex = (start + offset) % count;
+            if (victimIndex == workerIndex)
+                continue;
+
+            Worker &victim = *workers[victimIndex];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty())
+            {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                pendingTasks.fetch_sub(1);
+                tasksStolen.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void ThreadPool::runTask(int workerIndex, std::function<void()> &task)
+    {
+        auto start = std::chrono::steady_clock::now();
+        task();
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+
+        if (workerIndex >= 0)
+            workers[workerIndex]->busyNanoseconds.fetch_add(elapsed.count(), std::memory_order_relaxed);
+        tasksExecuted.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    bool ThreadPool::runPendingTask()
+    {
+        int workerIndex = (currentPool == this) ? currentWorker : -1;
+        std::function<void()> task;
+        if (!popTask(workerIndex, task))
+            return false;
+        runTask(workerIndex, task);
+        return true;
+    }
+
+    void ThreadPool::workerLoop(int workerIndex)
+    {
+        currentPool = this;
+        currentWorker = workerIndex;
+
+        while (true)
+        {
+            std::function<void()> task;
+            if (popTask(workerIndex, task))
+            {
+                runTask(workerIndex, task);
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            wakeUp.wait(lock, [this]()
+                        { return stopping || pendingTasks.load() > 0; });
+            if (stopping && pendingTasks.load() == 0)
+                return;
+        }
+    }
+
+    ThreadPoolStats ThreadPool::getStats() const
+    {
+        ThreadPoolStats stats;
+        stats.threads = size();
+        stats.tasksSubmitted = tasksSubmitted.load(std::memory_order_relaxed);
+        stats.tasksExecuted = tasksExecuted.load(std::memory_order_relaxed);
+        stats.tasksStolen = tasksStolen.load(std::memory_order_relaxed);
+
+        uint64_t busyNanoseconds = 0;
+        for (const auto &worker : workers)
+            busyNanoseconds += worker->busyNanoseconds.load(std::memory_order_relaxed);
+        stats.busySeconds = busyNanoseconds / 1e9;
+        stats.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - statsStart).count();
+        stats.utilisation = (stats.wallSeconds > 0) ? stats.busySeconds / (stats.wallSeconds * stats.threads) : 0.0;
+        return stats;
+    }
+
+    void ThreadPool::resetStats()
+    {
+        tasksSubmitted = 0;
+        tasksExecuted = 0;
+        tasksStolen = 0;
+        for (auto &worker : workers)
+            worker->busyNanoseconds = 0;
+        statsStart = std::chrono::steady_clock::now();
+    }
+
+    static std::unique_ptr<ThreadPool> enginePool;
+    static std::mutex enginePoolMutex;
+
+    ThreadPool &getThreadPool()
+    {
+        std::lock_guard<std::mutex> lock(enginePoolMutex);
+        if (!enginePool)
+            enginePool = std::make_unique<ThreadPool>(static_cast<int>(std::thread::hardware_concurrency()));
+        return *enginePool;
+    }
+
+    void setThreadCount(int threadCount)
+    {
+        std::lock_guard<std::mutex> lock(enginePoolMutex);
+        enginePool.reset(); // Join the old workers before starting new ones
+        enginePool = std::make_unique<ThreadPool>(threadCount);
+    }
+}
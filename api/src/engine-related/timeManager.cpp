@@ -0,0 +1,66 @@
+#include "engine-related/timeManager.h"
+
+#include <algorithm>
+#include "engine-related/searchThread.h"
+
+namespace coredump
+{
+    std::atomic<bool> searchStopped{false};
+
+    // Kept back from every clock budget for move transmission and the time the helpers take to unwind
+    constexpr double MOVE_OVERHEAD = 0.05;
+    // Sudden death (no movesToGo) spends the clock as if this many moves were left
+    constexpr int DEFAULT_MOVES_TO_GO = 30;
+    // Smallest share of a clock too short to plan with
+    constexpr double MINIMUM_BUDGET = 0.01;
+    // Part of a budget after which no new iteration is started. The next one usually costs more than all
+    // before it, so with less left it would just be thrown away at the hard limit
+    constexpr double ITERATION_START_FRACTION = 0.6;
+
+    void TimeManager::start(const SearchLimits &limits)
+    {
+        startTime = std::chrono::steady_clock::now();
+        searchStopped = false;
+        nodeLimit = limits.nodes;
+        depthLimit = (limits.depth > 0) ? std::min(limits.depth, MAX_PLY - 1) : MAX_PLY - 1;
+
+        if (limits.moveTime > 0)
+        {
+            // Fixed time: an iteration may run until the time is up, but one started late would not finish
+            hardSeconds = limits.moveTime;
+            softSeconds = hardSeconds * ITERATION_START_FRACTION;
+        }
+        else if (limits.remaining > 0)
+        {
+            // Clock: an even share of what is left plus most of the increment. An iteration may run over
+            // that share (the hard limit), but never far enough to put the clock itself at risk
+            const double available = std::max(limits.remaining - MOVE_OVERHEAD, MINIMUM_BUDGET);
+            const int movesToGo = (limits.movesToGo > 0) ? limits.movesToGo : DEFAULT_MOVES_TO_GO;
+            const double share = std::max(std::min(available / movesToGo + limits.increment * 0.75, available * 0.5), MINIMUM_BUDGET);
+            softSeconds = share * ITERATION_START_FRACTION;
+            hardSeconds = std::max(std::min(share * 4, available * 0.8), share);
+        }
+        else
+        {
+            softSeconds = hardSeconds = 0; // Depth or node limited only
+        }
+    }
+
+    void TimeManager::checkLimits(uint64_t nodes)
+    {
+        if ((nodeLimit && nodes >= nodeLimit) || (hardSeconds > 0 && elapsed() >= hardSeconds))
+            searchStopped = true; // Make every search thread unwind
+    }
+
+    bool TimeManager::shouldStop(int completedDepth) const
+    {
+        if (searchStopped.load(std::memory_order_relaxed) || completedDepth >= depthLimit)
+            return true;
+        return softSeconds > 0 && elapsed() >= softSeconds;
+    }
+
+    double TimeManager::elapsed() const
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    }
+}
@@ -1,37 +1,180 @@
 #include "extraHeuristics/transposition/transposition.h"
 
+#include <memory>
+#include <algorithm>
+
 namespace coredump
 {
-    std::unordered_map<uint64_t, TTEntry> transpositionTable;
+    // Table storage. Only ever reallocated by resizeTT, while no search is running
+    static std::unique_ptr<TTBucket[]> ttBuckets;
+    static size_t ttBucketMask = 0;
+    static uint8_t ttAge = 0;
+
+    // Layout of the 64 bit data word:
+    //   bits  0-15 packed best move
+    //   bits 16-31 score (int16)
+    //   bits 32-39 depth (int8)
+    //   bits 40-41 flag
+    //   bits 42-47 age of the search that wrote it
+    //   bit  48    occupied marker
+    constexpr int TT_AGE_BITS = 6;
+    constexpr uint8_t TT_AGE_MASK = (1 << TT_AGE_BITS) - 1;
+    constexpr uint64_t TT_OCCUPIED = 1ULL << 48;
+
+    inline uint64_t packData(uint16_t move, int score, int depth, TTFlag flag, uint8_t age)
+    {
+        score = std::clamp(score, static_cast<int>(INT16_MIN), static_cast<int>(INT16_MAX));
+        depth = std::clamp(depth, static_cast<int>(INT8_MIN), static_cast<int>(INT8_MAX));
+        return static_cast<uint64_t>(move) |
+               (static_cast<uint64_t>(static_cast<uint16_t>(score)) << 16) |
+               (static_cast<uint64_t>(static_cast<uint8_t>(depth)) << 32) |
+               (static_cast<uint64_t>(flag & 3) << 40) |
+               (static_cast<uint64_t>(age & TT_AGE_MASK) << 42) |
+               TT_OCCUPIED;
+    }
+
+    inline uint16_t dataMove(uint64_t data) { return static_cast<uint16_t>(data); }
+    inline int dataScore(uint64_t data) { return static_cast<int16_t>(data >> 16); }
+    inline int dataDepth(uint64_t data) { return static_cast<int8_t>(data >> 32); }
+    inline TTFlag dataFlag(uint64_t data) { return static_cast<TTFlag>((data >> 40) & 3); }
+    inline uint8_t dataAge(uint64_t data) { return (data >> 42) & TT_AGE_MASK; }
+
+    inline TTBucket &bucketFor(uint64_t zobristKey)
+    {
+        return ttBuckets[zobristKey & ttBucketMask];
+    }
 
-    void storeTT(uint64_t hash, int depth, int score, Move bestMove, TTFlag flag)
+    void resizeTT(size_t megabytes)
     {
-        auto it = transpositionTable.find(hash);
+        size_t bytes = std::max<size_t>(megabytes, 1) * 1024 * 1024;
+        size_t buckets = 1;
+        while (buckets * 2 * sizeof(TTBucket) <= bytes)
+            buckets *= 2;
 
-        // Replace only if the new depth is greater or equal (prevents shallow overwrites)
-        if (it == transpositionTable.end() || it->second.depth <= depth)
+        ttBuckets.reset(); // Release the old table before allocating the new one
+        ttBuckets.reset(new TTBucket[buckets]);
+        ttBucketMask = buckets - 1;
+        clearTT();
+    }
+
+    void clearTT()
+    {
+        if (!ttBuckets)
+            return;
+        for (size_t i = 0; i <= ttBucketMask; i++)
         {
-            transpositionTable[hash] = {hash, depth, score, bestMove, flag};
+            for (TTSlot &slot : ttBuckets[i].slots)
+            {
+                slot.key.store(0, std::memory_order_relaxed);
+                slot.data.store(0, std::memory_order_relaxed);
+            }
         }
+        ttAge = 0;
+    }
+
+    void newSearchTT()
+    {
+        ttAge = (ttAge + 1) & TT_AGE_MASK;
+    }
+
+    void prefetchTT(uint64_t zobristKey)
+    {
+        if (ttBuckets)
+            __builtin_prefetch(&bucketFor(zobristKey));
     }
 
-    TTEntry *probeTT(uint64_t zobristKey, int depth, int alpha, int beta)
+    void storeTT(uint64_t hash, int depth, int score, PackedMove bestMove, TTFlag flag)
     {
-        auto entry = transpositionTable.find(zobristKey);
-        if (entry == transpositionTable.end())
-            return nullptr; // No entry found
+        if (!ttBuckets)
+            return;
 
-        TTEntry *tt = &entry->second;
-        if (tt->depth >= depth)
+        TTBucket &bucket = bucketFor(hash);
+        uint16_t move = bestMove.data;
+
+        // Pick a victim: the slot already holding this position, otherwise the one with the
+        // lowest depth after penalising entries left over from older searches
+        TTSlot *replace = &bucket.slots[0];
+        int replaceWorth = INT32_MAX;
+        for (TTSlot &slot : bucket.slots)
         {
-            if (tt->flag == EXACT)
-                return tt;
-            if (tt->flag == LOWERBOUND && tt->score >= beta)
-                return tt;
-            if (tt->flag == UPPERBOUND && tt->score <= alpha)
-                return tt;
+            uint64_t data = slot.data.load(std::memory_order_relaxed);
+            uint64_t key = slot.key.load(std::memory_order_relaxed) ^ data;
+
+            if (!(data & TT_OCCUPIED))
+            {
+                if (replaceWorth > INT32_MIN)
+                {
+                    replace = &slot;
+                    replaceWorth = INT32_MIN;
+                }
+                continue;
+            }
+
+            if (key == hash)
+            {
+                // Same position: keep the old best move if we have none, and keep deeper data from this search
+                if (!move)
+                    move = dataMove(data);
+                if (dataAge(data) == ttAge && dataDepth(data) > depth && flag != EXACT)
+                    return;
+                replace = &slot;
+                break;
+            }
+
+            int relativeAge = (ttAge - dataAge(data)) & TT_AGE_MASK;
+            int worth = dataDepth(data) - 8 * relativeAge;
+            if (worth < replaceWorth)
+            {
+                replace = &slot;
+                replaceWorth = worth;
+            }
         }
 
-        return nullptr; // No usable data
+        uint64_t data = packData(move, score, depth, flag, ttAge);
+        replace->key.store(hash ^ data, std::memory_order_relaxed);
+        replace->data.store(data, std::memory_order_relaxed);
+    }
+
+    bool probeTT(uint64_t zobristKey, TTEntry &entry)
+    {
+        if (!ttBuckets)
+            return false;
+
+        TTBucket &bucket = bucketFor(zobristKey);
+        for (TTSlot &slot : bucket.slots)
+        {
+            uint64_t data = slot.data.load(std::memory_order_relaxed);
+            uint64_t key = slot.key.load(std::memory_order_relaxed);
+            if ((data & TT_OCCUPIED) && (key ^ data) == zobristKey)
+            {
+                entry.zobristKey = zobristKey;
+                entry.depth = dataDepth(data);
+                entry.score = dataScore(data);
+                entry.bestMove = PackedMove(dataMove(data));
+                entry.flag = dataFlag(data);
+                return true;
+            }
+        }
+
+        return false; // No entry found
+    }
+
+    int hashfullTT()
+    {
+        if (!ttBuckets)
+            return 0;
+
+        size_t sampled = std::min<size_t>(1000, ttBucketMask + 1);
+        int used = 0;
+        for (size_t i = 0; i < sampled; i++)
+        {
+            for (TTSlot &slot : ttBuckets[i].slots)
+            {
+                uint64_t data = slot.data.load(std::memory_order_relaxed);
+                if ((data & TT_OCCUPIED) && dataAge(data) == ttAge)
+                    used++;
+            }
+        }
+        return static_cast<int>(used * 1000 / (sampled * TT_BUCKET_SLOTS));
     }
-}
\ No newline at end of file
+}
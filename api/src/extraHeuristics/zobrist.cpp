@@ -2,25 +2,79 @@
 
 namespace coredump
 {
-    std::array<std::array<uint64_t, 64>, 12> zobristTable;
-    uint64_t zobristEnPassant[8];
-    uint64_t zobristCastling[16]; // 16 combinations of castling rights
-    uint64_t zobristTurn;
+    // std::mt19937_64 is not constexpr, so this is the same generator written out by hand. With the same
+    // fixed seed it produces exactly the keys std::mt19937_64(123456789) would, on every platform and every run
+    class ConstexprMT64
+    {
+    public:
+        constexpr explicit ConstexprMT64(uint64_t seed) : state{}, index(312)
+        {
+            state[0] = seed;
+            for (int i = 1; i < 312; i++)
+                state[i] = 6364136223846793005ULL * (state[i - 1] ^ (state[i - 1] >> 62)) + i;
+        }
+
+        constexpr uint64_t operator()()
+        {
+            if (index >= 312)
+                twist();
+
+            uint64_t x = state[index++];
+            x ^= (x >> 29) & 0x5555555555555555ULL;
+            x ^= (x << 17) & 0x71D67FFFEDA60000ULL;
+            x ^= (x << 37) & 0xFFF7EEE000000000ULL;
+            x ^= x >> 43;
+            return x;
+        }
+
+    private:
+        uint64_t state[312];
+        int index;
+
+        constexpr void twist()
+        {
+            for (int i = 0; i < 312; i++)
+            {
+                uint64_t x = (state[i] & 0xFFFFFFFF80000000ULL) | (state[(i + 1) % 312] & 0x7FFFFFFFULL);
+                uint64_t xA = x >> 1;
+                if (x & 1)
+                    xA ^= 0xB5026F5AA96619E9ULL;
+                state[i] = state[(i + 156) % 312] ^ xA;
+            }
+            index = 0;
+        }
+    };
 
-    // Initializes Zobrist hashing table
-    void initZobrist()
+    struct ZobristKeys
     {
-        std::mt19937_64 rng(123456789); // Fixed seed for reproducibility
-        std::uniform_int_distribution<uint64_t> dist;
+        std::array<std::array<uint64_t, 64>, 12> pieces;
+        std::array<uint64_t, 8> enPassant;
+        std::array<uint64_t, 16> castling;
+        uint64_t turn;
+    };
+
+    // Keys are drawn in the same order the old runtime initialiser used
+    static constexpr ZobristKeys buildZobristKeys()
+    {
+        ZobristKeys keys{};
+        ConstexprMT64 rng(123456789);
 
         for (int piece = 0; piece < 12; ++piece)
             for (int square = 0; square < 64; ++square)
-                zobristTable[piece][square] = dist(rng);
+                keys.pieces[piece][square] = rng();
 
         for (int i = 0; i < 8; ++i)
-            zobristEnPassant[i] = dist(rng);
+            keys.enPassant[i] = rng();
         for (int i = 0; i < 16; ++i)
-            zobristCastling[i] = dist(rng);
-        zobristTurn = dist(rng);
+            keys.castling[i] = rng();
+        keys.turn = rng();
+        return keys;
     }
-}
\ No newline at end of file
+
+    static constexpr ZobristKeys zobristKeys = buildZobristKeys();
+
+    constexpr std::array<std::array<uint64_t, 64>, 12> zobristTable = zobristKeys.pieces;
+    constexpr std::array<uint64_t, 8> zobristEnPassant = zobristKeys.enPassant;
+    constexpr std::array<uint64_t, 16> zobristCastling = zobristKeys.castling; // 16 combinations of castling rights
+    constexpr uint64_t zobristTurn = zobristKeys.turn;
+}
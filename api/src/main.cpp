@@ -1,6 +1,7 @@
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 #include "console.h"
+#include "move/perft.h"
 
 namespace py = pybind11;
 namespace cd = coredump;
@@ -13,18 +14,53 @@ PYBIND11_MODULE(core_dump_py, handle)
 	handle.attr("__description__") = "A chess engine written in C++ with Python bindings using pybind11.";
 	handle.attr("__license__") = "MIT";
 
-	handle.def("engine_init", []()
-			   { cd::initializeMagicBitboards(); });
+	handle.def("engine_init", &cd::initEngine);
+
+	handle.def("set_hash_size", &cd::resizeTT);
+	handle.def("clear_hash", &cd::clearTT);
+	handle.def("hashfull", &cd::hashfullTT);
+	handle.def("set_threads", &cd::setThreadCount);
+	handle.def("thread_pool_stats", []()
+			   { return cd::getThreadPool().getStats(); });
 
 	handle.def("find_best_move", [](const cd::Position &position, cd::Color color, int maxDepth, double timeLimitSeconds, bool debug)
 			   {
 		std::ostringstream debugStream;
 		cd::Move move = cd::findBestMove(position, color, maxDepth, timeLimitSeconds, debug, debugStream);
 		return py::make_tuple(move, debugStream.str()); });
+	// Same search under a SearchLimits (clock, increment, moves to go, nodes, depth)
+	handle.def("find_best_move_limits", [](const cd::Position &position, cd::Color color, const cd::SearchLimits &limits, bool debug)
+			   {
+		std::ostringstream debugStream;
+		cd::Move move = cd::findBestMove(position, color, limits, debug, debugStream);
+		return py::make_tuple(move, debugStream.str()); });
 
 	handle.def("find_random_move", &cd::findRandomMove);
-	handle.def("generate_moves", &cd::generateMoves);
+	handle.def("generate_moves", [](const cd::Position &position, cd::Color color)
+			   {
+		cd::MoveList moves = cd::generateMoves(position, color);
+		std::vector<cd::Move> converted;
+		for (cd::PackedMove move : moves)
+			converted.push_back(position.toMove(move));
+		return converted; });
+	// Full legal Move for the given from/to (and promotion piece), or None if it is illegal. No move list is built
+	handle.def("validate_move", [](const cd::Position &position, cd::Color color, const cd::Move &move) -> py::object
+			   {
+		if (move.fromSquare < 0 || move.fromSquare > 63 || move.toSquare < 0 || move.toSquare > 63)
+			return py::none();
+		cd::PackedMove packed = position.toPackedMove(move);
+		if (!cd::isLegal(position, color, packed))
+			return py::none();
+		return py::cast(position.toMove(packed)); });
 	handle.def("check_endgame_conditions", &cd::checkEndgameConditions);
+
+	handle.def("perft", &cd::perft, py::arg("position"), py::arg("depth"), py::arg("hash_mb") = 0, py::arg("parallel") = true);
+	handle.def("divide", &cd::divide, py::arg("position"), py::arg("depth"), py::arg("hash_mb") = 0, py::arg("parallel") = true);
+	handle.def("perft_suite", [](int maxDepth, size_t hashMegabytes, bool parallel)
+			   {
+		std::ostringstream report;
+		bool passed = cd::runPerftSuite(report, maxDepth, hashMegabytes, parallel);
+		return py::make_tuple(passed, report.str()); }, py::arg("max_depth") = 0, py::arg("hash_mb") = 0, py::arg("parallel") = true);
 	handle.def("invert_color", &cd::invertColor);
 
 	handle.def("get_promotion_piece", [](const std::string &piece)
@@ -35,6 +71,30 @@ PYBIND11_MODULE(core_dump_py, handle)
 				   }
 				   return cd::getPromotionPiece(piece[0]); });
 
+	// Bind the thread pool statistics snapshot to Python
+	py::class_<cd::ThreadPoolStats>(handle, "ThreadPoolStats")
+		.def_readonly("threads", &cd::ThreadPoolStats::threads)
+		.def_readonly("tasks_submitted", &cd::ThreadPoolStats::tasksSubmitted)
+		.def_readonly("tasks_executed", &cd::ThreadPoolStats::tasksExecuted)
+		.def_readonly("tasks_stolen", &cd::ThreadPoolStats::tasksStolen)
+		.def_readonly("busy_seconds", &cd::ThreadPoolStats::busySeconds)
+		.def_readonly("wall_seconds", &cd::ThreadPoolStats::wallSeconds)
+		.def_readonly("utilisation", &cd::ThreadPoolStats::utilisation);
+
+	py::class_<cd::SearchLimits>(handle, "SearchLimits")
+		.def(py::init<>())
+		.def_readwrite("depth", &cd::SearchLimits::depth)
+		.def_readwrite("nodes", &cd::SearchLimits::nodes)
+		.def_readwrite("move_time", &cd::SearchLimits::moveTime)
+		.def_readwrite("remaining", &cd::SearchLimits::remaining)
+		.def_readwrite("increment", &cd::SearchLimits::increment)
+		.def_readwrite("moves_to_go", &cd::SearchLimits::movesToGo);
+
+	// Bind a per-root-move perft count to Python
+	py::class_<cd::DivideEntry>(handle, "DivideEntry")
+		.def_readonly("move", &cd::DivideEntry::move)
+		.def_readonly("nodes", &cd::DivideEntry::nodes);
+
 	// Bind the Color enum to Python
 	py::enum_<cd::Color>(handle, "Color")
 		.value("WHITE", cd::Color::WHITE)
@@ -78,9 +138,10 @@ PYBIND11_MODULE(core_dump_py, handle)
 		.def(py::init<>())
 		.def(py::init<const cd::Position &>())
 		.def(py::init<const cd::Position &, const cd::Move &>())
+		.def(py::init<const std::string &>())
 		.def("get_square_char", &cd::Position::getSquareChar)
-		.def("make_move", &cd::Position::makeMove)
-		.def("undo_move", &cd::Position::undoMove)
+		.def("make_move", py::overload_cast<const cd::Move &>(&cd::Position::makeMove))
+		.def("undo_move", py::overload_cast<const cd::Move &>(&cd::Position::undoMove))
 		.def("display_position", &cd::Position::displayPosition)
 		.def("get_fen", &cd::Position::getFen);
 }
@@ -17,20 +17,23 @@ namespace coredump
         return (rank - '1') * 8 + file - 'a';
     }
 
+    std::string moveToString(PackedMove move)
+    {
+        std::string result = Move::toAlgebraic(move.from()) + Move::toAlgebraic(move.to());
+        if (move.isPromotion())
+            result += "nbrq"[static_cast<int>(move.promotionPiece()) - static_cast<int>(PieceType::KNIGHT)];
+        return result;
+    }
+
     // Constructor
     Move::Move(int from, int to, bool capture, PieceType type, Color col, bool castling,
                CastlingType castlingType, bool promotion,
-               PieceType promoPiece, uint64_t capturedBitboard,
-               PieceType capturedType, uint64_t prevWhite,
-               uint64_t prevBlack, uint64_t prevOccupiedSquares,
-               int enPassantSquare, uint8_t castlingRights, int kingSquare)
-        : fromSquare(from), toSquare(to), isCapture(capture), pieceType(type), color(col),
-          isCastling(castling), castlingType(castlingType), isPromotion(promotion),
-          promotionPiece(promoPiece), capturedPieceBitboard(capturedBitboard),
-          capturedPieceType(capturedType), prevWhitePieces(prevWhite),
-          prevBlackPieces(prevBlack), prevOccupied(prevOccupiedSquares),
-          prevEnPassantSquare(enPassantSquare), prevCastlingRights(castlingRights),
-          prevKingSquare(kingSquare) {}
+               PieceType promoPiece, PieceType capturedType,
+               int enPassantSquare, uint8_t castlingRights)
+        : fromSquare(from), toSquare(to), isCapture(capture), isCastling(castling),
+          pieceType(type), color(col), castlingType(castlingType), isPromotion(promotion),
+          promotionPiece(promoPiece), capturedPieceType(capturedType),
+          prevEnPassantSquare(enPassantSquare), prevCastlingRights(castlingRights) {}
 
     Move::Move(int from, int to, Color col) : Move()
     {
@@ -57,20 +60,15 @@ namespace coredump
         : fromSquare(-1),                     // Undefined (no square)
           toSquare(-1),                       // Undefined (no square)
           isCapture(false),                   // Undefined (no capture)
+          isCastling(false),                  // Undefined (not castling)
           pieceType(PieceType::NONE),         // Undefined (no piece)
           color(Color::WHITE),                // Default color (can be changed later)
-          isCastling(false),                  // Undefined (not castling)
           castlingType(CastlingType::NONE),   // Undefined (no castling)
           isPromotion(false),                 // Undefined (no promotion)
           promotionPiece(PieceType::NONE),    // Undefined (no promotion piece)
-          capturedPieceBitboard(0),           // Undefined (no captured piece)
           capturedPieceType(PieceType::NONE), // Undefined (no captured piece type)
-          prevWhitePieces(0),                 // Undefined (no previous white pieces)
-          prevBlackPieces(0),                 // Undefined (no previous black pieces)
-          prevOccupied(0),                    // Undefined (no previous occupied squares)
           prevEnPassantSquare(-1),            // Undefined (no en passant square)
-          prevCastlingRights(0),              // Undefined (no previous castling rights)
-          prevKingSquare(-1)                  // Undefined (no previous king position)
+          prevCastlingRights(0)               // Undefined (no previous castling rights)
     {
     }
 
@@ -130,13 +128,8 @@ namespace coredump
                castlingType == other.castlingType &&
                isPromotion == other.isPromotion &&
                promotionPiece == other.promotionPiece &&
-               capturedPieceBitboard == other.capturedPieceBitboard &&
                capturedPieceType == other.capturedPieceType &&
-               prevWhitePieces == other.prevWhitePieces &&
-               prevBlackPieces == other.prevBlackPieces &&
-               prevOccupied == other.prevOccupied &&
                prevEnPassantSquare == other.prevEnPassantSquare &&
-               prevCastlingRights == other.prevCastlingRights &&
-               prevKingSquare == other.prevKingSquare;
+               prevCastlingRights == other.prevCastlingRights;
     }
 }
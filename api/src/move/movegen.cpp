@@ -2,346 +2,661 @@
 
 namespace coredump
 {
-    std::vector<Move> generateMoves(const Position &pos, Color color)
+    // Adds all four promotions onto to from the given square
+    static inline void addPromotions(MoveList &moveList, int from, int to)
     {
-        std::vector<Move> moveList;
-
-        uint64_t ourPieces = (color == Color::WHITE) ? pos.getWhitePieces() : pos.getBlackPieces();
-        uint64_t enemyPieces = (color == Color::WHITE) ? pos.getBlackPieces() : pos.getWhitePieces();
-        uint64_t ourPiecesCopy = ourPieces; // Preserve original value for iteration
+        // Queen first, so callers that take the first matching move get a queen
+        moveList.push_back(PackedMove(from, to, MoveFlag::PROMOTION, PieceType::QUEEN));
+        moveList.push_back(PackedMove(from, to, MoveFlag::PROMOTION, PieceType::KNIGHT));
+        moveList.push_back(PackedMove(from, to, MoveFlag::PROMOTION, PieceType::ROOK));
+        moveList.push_back(PackedMove(from, to, MoveFlag::PROMOTION, PieceType::BISHOP));
+    }
 
-        // Loop thru ourPiecesCopy, popping
-        while (ourPiecesCopy)
+    // Adds one move per target square, or all four promotions when a pawn reaches the last rank
+    static inline void addPawnMoves(MoveList &moveList, int from, uint64_t targets)
+    {
+        while (targets)
         {
-            int square = popLSB(ourPiecesCopy); // Extract one piece at a time
+            int to = popLSB(targets);
+            if (to >= 56 || to <= 7)
+                addPromotions(moveList, from, to);
+            else
+                moveList.push_back(PackedMove(from, to));
+        }
+    }
 
-            // Is current square a pawn?
-            if ((pos.whitePawns | pos.blackPawns) & (1ULL << square))
-            {
-                uint64_t pawnMoves = getPawnMoves(square, color, pos.getOccupiedSquares(), pos);
-                while (pawnMoves)
-                {
-                    int targetSquare = popLSB(pawnMoves);
-                    bool isCapture = (enemyPieces & (1ULL << targetSquare)) != 0; // Check for enemy piece
-                    if (isCapture || !(ourPieces & (1ULL << targetSquare)))
-                    { // Valid capture or empty square
-                        Move move(square, targetSquare, isCapture, PieceType::PAWN, color, false);
-                        if (!wouldLeaveKingInCheck(pos, move))
-                        {
-                            // Handle promotion
-                            if ((color == Color::WHITE && targetSquare >= 56) || (color == Color::BLACK && targetSquare <= 7))
-                            {
-                                move.isPromotion = true;
-                                if (move.promotionPiece == PieceType::NONE ||
-                                    move.promotionPiece == PieceType::PAWN ||
-                                    move.promotionPiece == PieceType::KING)
-                                {
-                                    // Default to queen if no valid promotion piece is set
-                                    move.promotionPiece = PieceType::QUEEN;
-                                }
-                            }
-                            moveList.push_back(move);
-                        }
-                    }
-                }
-            }
-            // Is current square a knight?
-            else if ((pos.whiteKnights | pos.blackKnights) & (1ULL << square))
-            {
-                uint64_t knightMoves = getKnightMoves(square);
-                while (knightMoves)
-                {
-                    int targetSquare = popLSB(knightMoves);
-                    bool isCapture = (enemyPieces & (1ULL << targetSquare)) != 0; // Check for enemy piece
-                    if (isCapture || !(ourPieces & (1ULL << targetSquare)))
-                    { // Valid capture or empty square
-                        Move move(square, targetSquare, isCapture, PieceType::KNIGHT, color, false);
-                        if (!wouldLeaveKingInCheck(pos, move))
-                        {
-                            moveList.push_back(move);
-                        }
-                    }
-                }
-            }
-            // Bishop moves
-            else if ((pos.whiteBishops | pos.blackBishops) & (1ULL << square))
-            {
-                uint64_t bishopMoves = getBishopMoves(square, pos.getOccupiedSquares());
-                while (bishopMoves)
-                {
-                    int targetSquare = popLSB(bishopMoves);
-                    bool isCapture = (enemyPieces & (1ULL << targetSquare)) != 0; // Check for enemy piece
-                    if (isCapture || !(ourPieces & (1ULL << targetSquare)))
-                    { // Valid capture or empty square
-                        Move move(square, targetSquare, isCapture, PieceType::BISHOP, color, false);
-                        if (!wouldLeaveKingInCheck(pos, move))
-                        {
-                            moveList.push_back(move);
-                        }
-                    }
-                }
-            }
-            // Rook moves
-            else if ((pos.whiteRooks | pos.blackRooks) & (1ULL << square))
-            {
-                uint64_t rookMoves = getRookMoves(square, pos.getOccupiedSquares());
-                while (rookMoves)
-                {
-                    int targetSquare = popLSB(rookMoves);
-                    bool isCapture = (enemyPieces & (1ULL << targetSquare)) != 0; // Check for enemy piece
-                    if (isCapture || !(ourPieces & (1ULL << targetSquare)))
-                    { // Valid capture or empty square
-                        Move move(square, targetSquare, isCapture, PieceType::ROOK, color, false);
-                        if (!wouldLeaveKingInCheck(pos, move))
-                        {
-                            moveList.push_back(move);
-                        }
-                    }
-                }
-            }
-            // Queen moves
-            else if ((pos.whiteQueens | pos.blackQueens) & (1ULL << square))
-            {
-                uint64_t queenMoves = getQueenMoves(square, pos.getOccupiedSquares());
-                while (queenMoves)
-                {
-                    int targetSquare = popLSB(queenMoves);
-                    bool isCapture = (enemyPieces & (1ULL << targetSquare)) != 0; // Check for enemy piece
-                    if (isCapture || !(ourPieces & (1ULL << targetSquare)))
-                    { // Valid capture or empty square
-                        Move move(square, targetSquare, isCapture, PieceType::QUEEN, color, false);
-                        if (!wouldLeaveKingInCheck(pos, move))
-                        {
-                            moveList.push_back(move);
-                        }
-                    }
-                }
-            }
-            // King moves
-            else if ((pos.whiteKing | pos.blackKing) & (1ULL << square))
-            {
-                uint64_t kingMoves = getKingMoves(square);
-                while (kingMoves)
-                {
-                    int targetSquare = popLSB(kingMoves);
-                    bool isCapture = (enemyPieces & (1ULL << targetSquare)) != 0; // Check for enemy piece
-                    if (isCapture || !(ourPieces & (1ULL << targetSquare)))
-                    { // Valid capture or empty square
-                        Move move(square, targetSquare, isCapture, PieceType::KING, color, false);
-                        if (!wouldLeaveKingInCheck(pos, move))
-                        {
-                            moveList.push_back(move);
-                        }
-                    }
-                }
-            }
+    // Set-wise pawn targets: every target square was reached by a shift of Delta, so the origin is to - Delta
+    template <int Delta>
+    static inline void addShiftedPawnMoves(MoveList &moveList, uint64_t targets)
+    {
+        while (targets)
+        {
+            int to = popLSB(targets);
+            moveList.push_back(PackedMove(to - Delta, to));
         }
+    }
 
-        return moveList;
+    template <int Delta>
+    static inline void addShiftedPromotions(MoveList &moveList, uint64_t targets)
+    {
+        while (targets)
+        {
+            int to = popLSB(targets);
+            addPromotions(moveList, to - Delta, to);
+        }
     }
 
-    uint64_t getPawnMoves(int square, Color color, uint64_t occupied, const Position &pos)
+    static inline void addMoves(MoveList &moveList, int from, uint64_t targets)
     {
-        uint64_t moves = 0ULL;
-        uint64_t pawnBB = 1ULL << square;
+        while (targets)
+            moveList.push_back(PackedMove(from, popLSB(targets)));
+    }
 
-        if (color == Color::WHITE)
+    // Our pieces that are the only piece between kingSquare and one of the given sliders
+    static inline uint64_t singleBlockers(int kingSquare, uint64_t snipers, uint64_t occupied)
+    {
+        uint64_t result = 0ULL;
+        while (snipers)
         {
-            uint64_t singlePush = (pawnBB << 8) & ~occupied;
-            moves |= singlePush;
+            uint64_t blockers = betweenTable[kingSquare][popLSB(snipers)] & occupied;
+            if (blockers && !(blockers & (blockers - 1)))
+                result |= blockers;
+        }
+        return result;
+    }
 
-            if (pawnBB & RANK_2)
-            {
-                moves |= ((singlePush << 8) & ~occupied & RANK_4);
-            }
-            if ((square % 8) != 0)
-            {
-                moves |= ((pawnBB << 7) & pos.getBlackPieces() & ~FILE_H);
-            }
-            if ((square % 8) != 7)
-            {
-                moves |= ((pawnBB << 9) & pos.getBlackPieces() & ~FILE_A);
-            }
-            if (pos.enPassantSquare != -1 && square >= 24 && square < 32)
-            {
-                if ((square % 8) != 0 && pos.enPassantSquare == square + 7)
-                {
-                    moves |= (1ULL << pos.enPassantSquare);
-                }
-                if ((square % 8) != 7 && pos.enPassantSquare == square + 9)
-                {
-                    moves |= (1ULL << pos.enPassantSquare);
-                }
-            }
+    // Where a quiet move by a piece of type on from has to go to give check: a direct check square,
+    // or anywhere off the line to their king for a piece uncovering one of our sliders
+    template <Color Us>
+    static inline uint64_t quietCheckTargets(const Position &pos, PieceType type, int from)
+    {
+        constexpr Color Them = (Us == Color::WHITE) ? Color::BLACK : Color::WHITE;
+        uint64_t targets = checkSquares(pos, Us, type);
+        if ((discoverers(pos, Us) >> from) & 1)
+            targets |= ~lineTable[pos.kingSquare(Them)][from];
+        return targets;
+    }
+
+    // Pieces of one type that move along rays or jumps, minus pinned ones, which only keep their pin line
+    template <Color Us, PieceType Type, bool Checks>
+    static inline void addPieceMoves(MoveList &moveList, const Position &pos, uint64_t pinned, uint64_t targets, int kingSquare)
+    {
+        const uint64_t occupied = pos.getOccupiedSquares();
+        const uint64_t pieces = pos.pieces(Us, Type);
+        uint64_t free = pieces & ~pinned;
+        while (free)
+        {
+            int from = popLSB(free);
+            uint64_t moves = pieceAttacks<Type>(from, occupied) & targets;
+            if (Checks)
+                moves &= quietCheckTargets<Us>(pos, Type, from);
+            addMoves(moveList, from, moves);
         }
-        else
+        // A pinned knight can never stay on its pin line
+        if (Type == PieceType::KNIGHT)
+            return;
+        uint64_t pinnedPieces = pieces & pinned;
+        while (pinnedPieces)
         {
-            uint64_t singlePush = (pawnBB >> 8) & ~occupied;
-            moves |= singlePush;
-
-            if (pawnBB & RANK_7)
-            {
-                moves |= ((singlePush >> 8) & ~occupied & RANK_5);
-            }
-            if ((square % 8) != 0)
-            {
-                moves |= ((pawnBB >> 9) & pos.getWhitePieces() & ~FILE_H);
-            }
-            if ((square % 8) != 7)
-            {
-                moves |= ((pawnBB >> 7) & pos.getWhitePieces() & ~FILE_A);
-            }
-            if (pos.enPassantSquare != -1 && square >= 32 && square < 40)
-            {
-                if ((square % 8) != 0 && pos.enPassantSquare == square - 9)
-                {
-                    moves |= (1ULL << pos.enPassantSquare);
-                }
-                if ((square % 8) != 7 && pos.enPassantSquare == square - 7)
-                {
-                    moves |= (1ULL << pos.enPassantSquare);
-                }
-            }
+            int from = popLSB(pinnedPieces);
+            uint64_t moves = pieceAttacks<Type>(from, occupied) & targets & lineTable[kingSquare][from];
+            if (Checks)
+                moves &= quietCheckTargets<Us>(pos, Type, from);
+            addMoves(moveList, from, moves);
         }
+    }
+
+    // Checkers and pins for Us (the generator's copy, with the colour known at compile time)
+    template <Color Us>
+    static inline void computeChecks(const Position &pos)
+    {
+        constexpr Color Them = (Us == Color::WHITE) ? Color::BLACK : Color::WHITE;
+        const int kingSquare = pos.kingSquare(Us);
+        const uint64_t occupied = pos.getOccupiedSquares();
+        AttackInfo &info = pos.attackInfo;
 
-        return moves;
+        info.checkers[static_cast<int>(Us)] = ((getPawnAttacks<Us>(kingSquare) & pos.pieces(Them, PieceType::PAWN)) |
+                                               (getKnightMoves(kingSquare) & pos.pieces(Them, PieceType::KNIGHT)) |
+                                               (getBishopMoves(kingSquare, occupied) & pos.pieces(Them, PieceType::BISHOP, PieceType::QUEEN)) |
+                                               (getRookMoves(kingSquare, occupied) & pos.pieces(Them, PieceType::ROOK, PieceType::QUEEN)));
+        // A pinned piece is the only piece between the king and an enemy slider on a shared line
+        uint64_t snipers = (getRookMoves(kingSquare, 0ULL) & pos.pieces(Them, PieceType::ROOK, PieceType::QUEEN)) |
+                           (getBishopMoves(kingSquare, 0ULL) & pos.pieces(Them, PieceType::BISHOP, PieceType::QUEEN));
+        info.pinned[static_cast<int>(Us)] = snipers ? singleBlockers(kingSquare, snipers, occupied) & pos.pieces(Us) : 0ULL;
+        info.valid |= AttackInfo::bit(AttackInfo::CHECKS, Us);
     }
 
-    uint64_t getCastlingMoves(Color color, uint64_t occupied, const Position &pos)
+    // Fully legal generation: checkers and pins are found once, then every piece is masked instead of
+    // each candidate being made and tested. Only king moves and en passant still need an attack probe
+    template <Color Us, GenType Type>
+    void generateMoves(const Position &pos, MoveList &moveList)
     {
-        uint64_t moves = 0ULL;
+        constexpr Color Them = (Us == Color::WHITE) ? Color::BLACK : Color::WHITE;
+        constexpr bool Captures = (Type != GenType::QUIETS && Type != GenType::QUIET_CHECKS); // Captures, promotions, en passant
+        constexpr bool Quiets = (Type != GenType::CAPTURES);
+        constexpr bool Checks = (Type == GenType::QUIET_CHECKS);
+        constexpr uint64_t PromotionRank = (Us == Color::WHITE) ? RANK_8 : RANK_1;
+        constexpr uint64_t PromotingRank = (Us == Color::WHITE) ? RANK_7 : RANK_2; // Pawns one step from promoting
+        constexpr uint64_t ThirdRank = (Us == Color::WHITE) ? RANK_3 : RANK_6;     // Single pushes that may push again
+        constexpr int Up = (Us == Color::WHITE) ? 8 : -8;
+        constexpr int UpWest = (Us == Color::WHITE) ? 7 : -9;
+        constexpr int UpEast = (Us == Color::WHITE) ? 9 : -7;
+        constexpr int EnPassantRank = (Us == Color::WHITE) ? 5 : 2;
+        constexpr int HomeSquare = (Us == Color::WHITE) ? 4 : 60;
+        constexpr uint8_t KingsideRight = (Us == Color::WHITE) ? 1 << 0 : 1 << 2;
+        constexpr uint8_t QueensideRight = (Us == Color::WHITE) ? 1 << 1 : 1 << 3;
 
-        if (color == Color::WHITE)
+        const uint64_t ourPieces = pos.pieces(Us);
+        const uint64_t enemyPieces = pos.pieces(Them);
+        const uint64_t occupied = pos.getOccupiedSquares();
+
+        const int kingSquare = pos.kingSquare(Us);
+        const uint64_t enemyRookLike = pos.pieces(Them, PieceType::ROOK, PieceType::QUEEN);
+        const uint64_t enemyBishopLike = pos.pieces(Them, PieceType::BISHOP, PieceType::QUEEN);
+
+        if (!(pos.attackInfo.valid & AttackInfo::bit(AttackInfo::CHECKS, Us)))
+            computeChecks<Us>(pos);
+        const uint64_t checkers = pos.attackInfo.checkers[static_cast<int>(Us)];
+
+        // Destination squares this generation type allows, before check and pin restrictions
+        const uint64_t typeTargets = !Quiets ? enemyPieces : (!Captures ? ~occupied : ~ourPieces);
+
+        // King moves: anywhere the enemy doesn't attack, seen through our king so it can't hide behind itself
+        uint64_t kingTargets = getKingMoves(kingSquare) & typeTargets;
+        if (Checks)
+            kingTargets &= quietCheckTargets<Us>(pos, PieceType::KING, kingSquare);
+        const uint64_t withoutKing = occupied ^ (1ULL << kingSquare);
+        while (kingTargets)
+        {
+            int to = popLSB(kingTargets);
+            if (!isAttackedBy<Them>(to, withoutKing, pos))
+                moveList.push_back(PackedMove(kingSquare, to));
+        }
+
+        // Double check: only the king can move
+        if (__builtin_popcountll(checkers) > 1)
+            return;
+
+        // Single check: other pieces must capture the checker or block the line to the king
+        const uint64_t checkMask = checkers ? (betweenTable[kingSquare][__builtin_ctzll(checkers)] | checkers) : ~0ULL;
+
+        const uint64_t pinned = pos.attackInfo.pinned[static_cast<int>(Us)];
+
+        const uint64_t targets = typeTargets & checkMask;
+
+        // Pawns, unpinned ones all at once with shifts. Promotions count as captures, the other pushes as quiets
+        // Pawns that could give discovered check go through the slow path with the pinned ones
+        const uint64_t pawns = pos.pieces(Us, PieceType::PAWN);
+        const uint64_t slowPawns = pawns & (Checks ? pinned | discoverers(pos, Us) : pinned);
+        const uint64_t freePawns = pawns & ~slowPawns;
+        const uint64_t promoting = freePawns & PromotingRank;
+        const uint64_t notPromoting = freePawns & ~PromotingRank;
+        const uint64_t empty = ~occupied;
+
+        if (Quiets)
         {
-            if (pos.castlingRights & (1 << 0))
+            const uint64_t pushTargets = checkMask & (Checks ? checkSquares(pos, Us, PieceType::PAWN) : ~0ULL);
+            uint64_t singlePushes = shift<Up>(notPromoting) & empty;
+            uint64_t doublePushes = shift<Up>(singlePushes & ThirdRank) & empty;
+            addShiftedPawnMoves<Up>(moveList, singlePushes & pushTargets);
+            addShiftedPawnMoves<Up + Up>(moveList, doublePushes & pushTargets);
+        }
+        if (Captures)
+        {
+            const uint64_t captureTargets = enemyPieces & checkMask;
+            addShiftedPawnMoves<UpWest>(moveList, shift<UpWest>(notPromoting) & captureTargets);
+            addShiftedPawnMoves<UpEast>(moveList, shift<UpEast>(notPromoting) & captureTargets);
+            if (promoting)
             {
-                // Check if squares between king and rook are empty and not attacked
-                if (!getBit(occupied, 5) && !getBit(occupied, 6) &&
-                    !isSquareAttacked(4, Color::BLACK, pos) &&
-                    !isSquareAttacked(5, Color::BLACK, pos) &&
-                    !isSquareAttacked(6, Color::BLACK, pos))
-                {
-                    moves |= (1ULL << 6); // g1
-                }
+                addShiftedPromotions<Up>(moveList, shift<Up>(promoting) & empty & checkMask);
+                addShiftedPromotions<UpWest>(moveList, shift<UpWest>(promoting) & captureTargets);
+                addShiftedPromotions<UpEast>(moveList, shift<UpEast>(promoting) & captureTargets);
             }
-            if (pos.castlingRights & (1 << 1))
+        }
+
+        // Pinned (rare) and discovering pawns one at a time, pinned ones kept on their pin line
+        uint64_t pawnsLeft = slowPawns;
+        while (pawnsLeft)
+        {
+            int from = popLSB(pawnsLeft);
+            uint64_t fromBB = 1ULL << from;
+
+            uint64_t pushes = shift<Up>(fromBB) & empty;
+            pushes |= shift<Up>(pushes & ThirdRank) & empty;
+
+            uint64_t moves = 0ULL;
+            if (Captures)
+                moves |= (getPawnAttacks<Us>(from) & enemyPieces) | (pushes & PromotionRank);
+            if (Quiets)
+                moves |= pushes & ~PromotionRank;
+            if (pinned & fromBB)
+                moves &= lineTable[kingSquare][from];
+            if (Checks)
+                moves &= quietCheckTargets<Us>(pos, PieceType::PAWN, from);
+            addPawnMoves(moveList, from, moves & checkMask);
+        }
+
+        // En passant: lifts two pawns off one rank at once, so test the resulting slider lines directly
+        const int epSquare = pos.enPassantSquare;
+        if (Captures && epSquare != -1 && epSquare / 8 == EnPassantRank)
+        {
+            const int capturedSquare = epSquare - Up;
+            const uint64_t capturedBB = 1ULL << capturedSquare;
+            // Only a pawn that just double pushed can be taken, and only if that resolves any check
+            if ((pos.pieces(Them, PieceType::PAWN) & capturedBB) && (checkMask & ((1ULL << epSquare) | capturedBB)))
             {
-                // Check if squares between king and rook are empty and not attacked
-                if (!getBit(occupied, 1) && !getBit(occupied, 2) && !getBit(occupied, 3) &&
-                    !isSquareAttacked(4, Color::BLACK, pos) &&
-                    !isSquareAttacked(3, Color::BLACK, pos) &&
-                    !isSquareAttacked(2, Color::BLACK, pos))
+                uint64_t capturers = getPawnAttacks<Them>(epSquare) & pawns;
+                while (capturers)
                 {
-                    moves |= (1ULL << 2); // c1
+                    int from = popLSB(capturers);
+                    uint64_t after = (occupied ^ (1ULL << from) ^ capturedBB) | (1ULL << epSquare);
+                    if (!(getRookMoves(kingSquare, after) & enemyRookLike) && !(getBishopMoves(kingSquare, after) & enemyBishopLike))
+                        moveList.push_back(PackedMove(from, epSquare, MoveFlag::EN_PASSANT));
                 }
             }
         }
-        else
+
+        addPieceMoves<Us, PieceType::KNIGHT, Checks>(moveList, pos, pinned, targets, kingSquare);
+        addPieceMoves<Us, PieceType::BISHOP, Checks>(moveList, pos, pinned, targets, kingSquare);
+        addPieceMoves<Us, PieceType::ROOK, Checks>(moveList, pos, pinned, targets, kingSquare);
+        addPieceMoves<Us, PieceType::QUEEN, Checks>(moveList, pos, pinned, targets, kingSquare);
+
+        // Castling: not out of check, path empty, and the king never crosses an attacked square
+        // Evasions are only asked for in check, and checks by castling are too rare to hunt for
+        if (Quiets && Type != GenType::EVASIONS && !Checks && !checkers && kingSquare == HomeSquare)
         {
-            if (pos.castlingRights & (1 << 2))
+            const uint64_t ourRooks = pos.pieces(Us, PieceType::ROOK);
+            if ((pos.castlingRights & KingsideRight) && (ourRooks & (1ULL << (HomeSquare + 3))) &&
+                !(occupied & betweenTable[HomeSquare][HomeSquare + 3]) &&
+                !isAttackedBy<Them>(HomeSquare + 1, occupied, pos) && !isAttackedBy<Them>(HomeSquare + 2, occupied, pos))
             {
-                // Check if squares between king and rook are empty and not attacked
-                if (!getBit(occupied, 61) && !getBit(occupied, 62) &&
-                    !isSquareAttacked(60, Color::WHITE, pos) &&
-                    !isSquareAttacked(61, Color::WHITE, pos) &&
-                    !isSquareAttacked(62, Color::WHITE, pos))
-                {
-                    moves |= (1ULL << 62); // g8
-                }
+                moveList.push_back(PackedMove(HomeSquare, HomeSquare + 2, MoveFlag::CASTLING));
             }
-            if (pos.castlingRights & (1 << 3))
+            if ((pos.castlingRights & QueensideRight) && (ourRooks & (1ULL << (HomeSquare - 4))) &&
+                !(occupied & betweenTable[HomeSquare][HomeSquare - 4]) &&
+                !isAttackedBy<Them>(HomeSquare - 1, occupied, pos) && !isAttackedBy<Them>(HomeSquare - 2, occupied, pos))
             {
-                // Check if squares between king and rook are empty and not attacked
-                if (!getBit(occupied, 57) && !getBit(occupied, 58) && !getBit(occupied, 59) &&
-                    !isSquareAttacked(60, Color::WHITE, pos) &&
-                    !isSquareAttacked(59, Color::WHITE, pos) &&
-                    !isSquareAttacked(58, Color::WHITE, pos))
-                {
-                    moves |= (1ULL << 58); // c8
-                }
+                moveList.push_back(PackedMove(HomeSquare, HomeSquare - 2, MoveFlag::CASTLING));
             }
         }
+    }
+
+    template void generateMoves<Color::WHITE, GenType::ALL>(const Position &, MoveList &);
+    template void generateMoves<Color::WHITE, GenType::CAPTURES>(const Position &, MoveList &);
+    template void generateMoves<Color::WHITE, GenType::QUIETS>(const Position &, MoveList &);
+    template void generateMoves<Color::WHITE, GenType::EVASIONS>(const Position &, MoveList &);
+    template void generateMoves<Color::WHITE, GenType::QUIET_CHECKS>(const Position &, MoveList &);
+    template void generateMoves<Color::BLACK, GenType::ALL>(const Position &, MoveList &);
+    template void generateMoves<Color::BLACK, GenType::CAPTURES>(const Position &, MoveList &);
+    template void generateMoves<Color::BLACK, GenType::QUIETS>(const Position &, MoveList &);
+    template void generateMoves<Color::BLACK, GenType::EVASIONS>(const Position &, MoveList &);
+    template void generateMoves<Color::BLACK, GenType::QUIET_CHECKS>(const Position &, MoveList &);
 
-        return moves;
+    template <Color Us>
+    static void generateMovesFor(const Position &pos, GenType type, MoveList &moveList)
+    {
+        switch (type)
+        {
+        case GenType::CAPTURES:
+            return generateMoves<Us, GenType::CAPTURES>(pos, moveList);
+        case GenType::QUIETS:
+            return generateMoves<Us, GenType::QUIETS>(pos, moveList);
+        case GenType::EVASIONS:
+            return generateMoves<Us, GenType::EVASIONS>(pos, moveList);
+        case GenType::QUIET_CHECKS:
+            return generateMoves<Us, GenType::QUIET_CHECKS>(pos, moveList);
+        default:
+            return generateMoves<Us, GenType::ALL>(pos, moveList);
+        }
+    }
+
+    // The one runtime colour/type branch; everything below it is resolved at compile time
+    MoveList generateMoves(const Position &pos, Color color, GenType type)
+    {
+        MoveList moveList;
+        if (color == Color::WHITE)
+            generateMovesFor<Color::WHITE>(pos, type, moveList);
+        else
+            generateMovesFor<Color::BLACK>(pos, type, moveList);
+        return moveList;
+    }
+
+    uint64_t attackersTo(int square, uint64_t occupied, const Position &pos)
+    {
+        return (getPawnAttacks(square, Color::WHITE) & pos.pieces(Color::BLACK, PieceType::PAWN)) |
+               (getPawnAttacks(square, Color::BLACK) & pos.pieces(Color::WHITE, PieceType::PAWN)) |
+               (getKnightMoves(square) & pos.pieces(PieceType::KNIGHT)) |
+               (getBishopMoves(square, occupied) & pos.pieces(PieceType::BISHOP, PieceType::QUEEN)) |
+               (getRookMoves(square, occupied) & pos.pieces(PieceType::ROOK, PieceType::QUEEN)) |
+               (getKingMoves(square) & pos.pieces(PieceType::KING));
     }
 
     bool isSquareAttacked(int square, Color attackingColor, const Position &pos)
     {
-        uint64_t occupied = pos.getWhitePieces() | pos.getBlackPieces();
+        return (attackingColor == Color::WHITE) ? isAttackedBy<Color::WHITE>(square, pos.getOccupiedSquares(), pos)
+                                                : isAttackedBy<Color::BLACK>(square, pos.getOccupiedSquares(), pos);
+    }
+
+    bool isInCheck(const Position &pos, Color color)
+    {
+        return checkers(pos, color) != 0;
+    }
+
+    void computeChecks(const Position &pos, Color color)
+    {
+        (color == Color::WHITE) ? computeChecks<Color::WHITE>(pos) : computeChecks<Color::BLACK>(pos);
+    }
+
+    void computeCheckSquares(const Position &pos, Color color)
+    {
+        const int theirKing = pos.kingSquare(invertColor(color));
+        const uint64_t occupied = pos.getOccupiedSquares();
+        AttackInfo &info = pos.attackInfo;
+        uint64_t *squares = info.checkSquares[static_cast<int>(color)];
+
+        squares[static_cast<int>(PieceType::PAWN)] = getPawnAttacks(theirKing, invertColor(color));
+        squares[static_cast<int>(PieceType::KNIGHT)] = getKnightMoves(theirKing);
+        squares[static_cast<int>(PieceType::BISHOP)] = getBishopMoves(theirKing, occupied);
+        squares[static_cast<int>(PieceType::ROOK)] = getRookMoves(theirKing, occupied);
+        squares[static_cast<int>(PieceType::QUEEN)] = squares[static_cast<int>(PieceType::BISHOP)] | squares[static_cast<int>(PieceType::ROOK)];
+        squares[static_cast<int>(PieceType::KING)] = 0ULL;
+
+        uint64_t ourSnipers = (getRookMoves(theirKing, 0ULL) & pos.pieces(color, PieceType::ROOK, PieceType::QUEEN)) |
+                              (getBishopMoves(theirKing, 0ULL) & pos.pieces(color, PieceType::BISHOP, PieceType::QUEEN));
+        info.discoverers[static_cast<int>(color)] = singleBlockers(theirKing, ourSnipers, occupied) & pos.pieces(color);
+        info.valid |= AttackInfo::bit(AttackInfo::CHECK_SQUARES, color);
+    }
+
+    bool givesCheck(const Position &pos, PackedMove move)
+    {
+        const int from = move.from();
+        const int to = move.to();
+        const int moverIndex = pos.pieceIndexOn(from);
+        if (moverIndex == NO_PIECE)
+            return false;
+        const Color us = (moverIndex >= 6) ? Color::BLACK : Color::WHITE;
+        const PieceType type = static_cast<PieceType>(moverIndex % 6);
+        const uint64_t fromBB = 1ULL << from;
+        const uint64_t toBB = 1ULL << to;
+        const int theirKing = pos.kingSquare(invertColor(us));
+
+        // Direct check from the destination (a promoting pawn checks as its new piece, below)
+        if (!move.isPromotion() && (checkSquares(pos, us, type) & toBB))
+            return true;
 
-        // Check for pawn attacks
-        if (attackingColor == Color::WHITE)
+        // Discovered check: the mover steps off the line between one of our sliders and their king
+        if ((discoverers(pos, us) & fromBB) && !(lineTable[theirKing][from] & toBB))
+            return true;
+
+        const uint64_t occupied = pos.getOccupiedSquares();
+        const uint64_t theirKingBB = 1ULL << theirKing;
+        switch (move.flag())
+        {
+        case MoveFlag::PROMOTION:
         {
-            if (((square > 7) && (((square % 8) > 0) && getBit(pos.whitePawns, square - 9))) ||
-                ((square % 8) < 7 && getBit(pos.whitePawns, square - 7)))
+            // The pawn's own square opens up, so a slider promoting along that line still checks
+            const uint64_t after = occupied ^ fromBB;
+            switch (move.promotionPiece())
             {
-                return true;
+            case PieceType::KNIGHT:
+                return getKnightMoves(to) & theirKingBB;
+            case PieceType::BISHOP:
+                return getBishopMoves(to, after) & theirKingBB;
+            case PieceType::ROOK:
+                return getRookMoves(to, after) & theirKingBB;
+            default:
+                return getQueenMoves(to, after) & theirKingBB;
             }
         }
-        else
+        case MoveFlag::EN_PASSANT:
         {
-            if (((square < 56 && ((square % 8) > 0) && getBit(pos.blackPawns, square + 7)) ||
-                 (((square % 8) < 7) && getBit(pos.blackPawns, square + 9))))
-            {
-                return true;
-            }
+            // Two pawns leave one rank at once, which can uncover a slider neither one shields alone
+            const uint64_t capturedBB = 1ULL << (us == Color::WHITE ? to - 8 : to + 8);
+            const uint64_t after = (occupied ^ fromBB ^ capturedBB) | toBB;
+            return (getRookMoves(theirKing, after) & pos.pieces(us, PieceType::ROOK, PieceType::QUEEN)) ||
+                   (getBishopMoves(theirKing, after) & pos.pieces(us, PieceType::BISHOP, PieceType::QUEEN));
+        }
+        case MoveFlag::CASTLING:
+        {
+            int rookFrom, rookTo;
+            castlingRookSquares(to, rookFrom, rookTo);
+            const uint64_t after = (occupied ^ fromBB ^ (1ULL << rookFrom)) | toBB | (1ULL << rookTo);
+            return getRookMoves(rookTo, after) & theirKingBB;
+        }
+        default:
+            return false;
+        }
+    }
+
+    // Whether move is one the generator could produce for Us if it ignored checks and pins
+    // Castling is the exception: every castling condition is checked here, so castling moves are fully legal
+    template <Color Us>
+    static bool isPseudoLegal(const Position &pos, PackedMove move)
+    {
+        constexpr Color Them = (Us == Color::WHITE) ? Color::BLACK : Color::WHITE;
+        constexpr uint64_t PromotionRank = (Us == Color::WHITE) ? RANK_8 : RANK_1;
+        constexpr uint64_t ThirdRank = (Us == Color::WHITE) ? RANK_3 : RANK_6;
+        constexpr int Up = (Us == Color::WHITE) ? 8 : -8;
+        constexpr int EnPassantRank = (Us == Color::WHITE) ? 5 : 2;
+        constexpr int HomeSquare = (Us == Color::WHITE) ? 4 : 60;
+        constexpr uint8_t KingsideRight = (Us == Color::WHITE) ? 1 << 0 : 1 << 2;
+        constexpr uint8_t QueensideRight = (Us == Color::WHITE) ? 1 << 1 : 1 << 3;
+
+        const int from = move.from();
+        const int to = move.to();
+        const uint64_t toBB = 1ULL << to;
+        const uint64_t occupied = pos.getOccupiedSquares();
+        const int moverIndex = pos.pieceIndexOn(from, Us);
+        if (from == to || moverIndex == -1 || (pos.pieces(Us) & toBB))
+            return false;
+        const PieceType type = static_cast<PieceType>(moverIndex % 6);
+
+        // Only promotions may carry promotion bits, so every 16 bit value maps to at most one move
+        if (!move.isPromotion() && move.promotionPiece() != PieceType::KNIGHT)
+            return false;
+
+        switch (move.flag())
+        {
+        case MoveFlag::CASTLING:
+        {
+            if (type != PieceType::KING || from != HomeSquare || (to != HomeSquare + 2 && to != HomeSquare - 2) || checkers(pos, Us))
+                return false;
+            const bool kingside = to == HomeSquare + 2;
+            const int rookSquare = kingside ? HomeSquare + 3 : HomeSquare - 4;
+            const int step = kingside ? 1 : -1;
+            return (pos.castlingRights & (kingside ? KingsideRight : QueensideRight)) &&
+                   (pos.pieces(Us, PieceType::ROOK) & (1ULL << rookSquare)) &&
+                   !(occupied & betweenTable[HomeSquare][rookSquare]) &&
+                   !isAttackedBy<Them>(HomeSquare + step, occupied, pos) && !isAttackedBy<Them>(HomeSquare + 2 * step, occupied, pos);
+        }
+        case MoveFlag::EN_PASSANT:
+            return type == PieceType::PAWN && to == pos.enPassantSquare && to / 8 == EnPassantRank &&
+                   (getPawnAttacks<Us>(from) & toBB) && (pos.pieces(Them, PieceType::PAWN) & (1ULL << (to - Up)));
+        default:
+            break;
         }
 
-        // Check for knight attacks
-        uint64_t knightAttacks = getKnightMoves(square);
-        if (knightAttacks & (attackingColor == Color::WHITE ? pos.whiteKnights : pos.blackKnights))
-            return true;
+        if (type == PieceType::PAWN)
+        {
+            // Reaching the last rank must be a promotion, and nothing else may be
+            if (move.isPromotion() != bool(toBB & PromotionRank))
+                return false;
+            const uint64_t fromBB = 1ULL << from;
+            const uint64_t singlePush = shift<Up>(fromBB) & ~occupied;
+            const uint64_t doublePush = shift<Up>(singlePush & ThirdRank) & ~occupied;
+            return ((getPawnAttacks<Us>(from) & pos.pieces(Them)) | singlePush | doublePush) & toBB;
+        }
+        if (move.isPromotion())
+            return false;
 
-        // Check for bishop/queen attacks
-        uint64_t bishopAttacks = getBishopMoves(square, occupied);
-        if (bishopAttacks & (attackingColor == Color::WHITE ? (pos.whiteBishops | pos.whiteQueens) : (pos.blackBishops | pos.blackQueens)))
-            return true;
+        switch (type)
+        {
+        case PieceType::KNIGHT:
+            return getKnightMoves(from) & toBB;
+        case PieceType::BISHOP:
+            return getBishopMoves(from, occupied) & toBB;
+        case PieceType::ROOK:
+            return getRookMoves(from, occupied) & toBB;
+        case PieceType::QUEEN:
+            return getQueenMoves(from, occupied) & toBB;
+        default:
+            return getKingMoves(from) & toBB;
+        }
+    }
 
-        // Check for rook/queen attacks
-        uint64_t rookAttacks = getRookMoves(square, occupied);
-        if (rookAttacks & (attackingColor == Color::WHITE ? (pos.whiteRooks | pos.whiteQueens) : (pos.blackRooks | pos.blackQueens)))
-            return true;
+    // Whether a pseudo-legal move for Us leaves its own king safe, from the cached checkers and pins
+    template <Color Us>
+    static bool isLegal(const Position &pos, PackedMove move)
+    {
+        constexpr Color Them = (Us == Color::WHITE) ? Color::BLACK : Color::WHITE;
+        const int from = move.from();
+        const int to = move.to();
+        const uint64_t toBB = 1ULL << to;
+        const int kingSquare = pos.kingSquare(Us);
+        const uint64_t occupied = pos.getOccupiedSquares();
 
-        // Check for king attacks
-        uint64_t kingAttacks = getKingMoves(square);
-        if (kingAttacks & (attackingColor == Color::WHITE ? pos.whiteKing : pos.blackKing))
+        if (move.isCastling())
             return true;
 
-        return false;
+        // Same tests as the generator: the capture must resolve any check, then both pawns leave the rank at once
+        if (move.isEnPassant())
+        {
+            const uint64_t capturedBB = 1ULL << (Us == Color::WHITE ? to - 8 : to + 8);
+            const uint64_t checking = checkers(pos, Us);
+            if (checking && ((checking & (checking - 1)) || !((betweenTable[kingSquare][__builtin_ctzll(checking)] | checking) & (toBB | capturedBB))))
+                return false;
+            const uint64_t after = (occupied ^ (1ULL << from) ^ capturedBB) | toBB;
+            return !(getRookMoves(kingSquare, after) & pos.pieces(Them, PieceType::ROOK, PieceType::QUEEN)) &&
+                   !(getBishopMoves(kingSquare, after) & pos.pieces(Them, PieceType::BISHOP, PieceType::QUEEN));
+        }
+
+        if (from == kingSquare)
+            return !isAttackedBy<Them>(to, occupied ^ (1ULL << kingSquare), pos);
+
+        // Other pieces must capture or block a single checker, and can't answer a double check at all
+        const uint64_t checking = checkers(pos, Us);
+        if (checking && ((checking & (checking - 1)) || !((betweenTable[kingSquare][__builtin_ctzll(checking)] | checking) & toBB)))
+            return false;
+
+        return !((pinnedPieces(pos, Us) >> from) & 1) || (lineTable[kingSquare][from] & toBB);
     }
 
-    std::vector<Move> generateCaptures(const Position &pos, Color color)
+    // Stops at the first legal move. Castling is skipped: a legal castle means the king could also step to the
+    // empty, unattacked square next to it, which the king loop already found
+    template <Color Us>
+    static bool hasAnyLegalMove(const Position &pos)
     {
-        std::vector<Move> allMoves = generateMoves(pos, color);
-        std::vector<Move> captures;
-        captures.reserve(20);
+        constexpr Color Them = (Us == Color::WHITE) ? Color::BLACK : Color::WHITE;
+        constexpr int Up = (Us == Color::WHITE) ? 8 : -8;
+        constexpr int UpWest = (Us == Color::WHITE) ? 7 : -9;
+        constexpr int UpEast = (Us == Color::WHITE) ? 9 : -7;
+        constexpr uint64_t ThirdRank = (Us == Color::WHITE) ? RANK_3 : RANK_6;
+
+        const uint64_t ourPieces = pos.pieces(Us);
+        const uint64_t enemyPieces = pos.pieces(Them);
+        const uint64_t occupied = pos.getOccupiedSquares();
+        const int kingSquare = pos.kingSquare(Us);
 
-        std::copy_if(allMoves.begin(), allMoves.end(), std::back_inserter(captures),
-                     [](const Move &move)
-                     { return move.isCapture || move.isPromotion; });
+        // King moves first: they answer every check, and most positions have one
+        uint64_t kingTargets = getKingMoves(kingSquare) & ~ourPieces;
+        const uint64_t withoutKing = occupied ^ (1ULL << kingSquare);
+        while (kingTargets)
+        {
+            if (!isAttackedBy<Them>(popLSB(kingTargets), withoutKing, pos))
+                return true;
+        }
+
+        const uint64_t checking = checkers(pos, Us);
+        if (checking & (checking - 1))
+            return false; // Double check: only the king could have moved
+        const uint64_t checkMask = checking ? (betweenTable[kingSquare][__builtin_ctzll(checking)] | checking) : ~0ULL;
+        const uint64_t pinned = pinnedPieces(pos, Us);
+        const uint64_t targets = ~ourPieces & checkMask;
 
-        return captures;
+        // Unpinned pawns set-wise, pinned ones kept on their pin line
+        const uint64_t pawns = pos.pieces(Us, PieceType::PAWN);
+        const uint64_t freePawns = pawns & ~pinned;
+        const uint64_t singlePushes = shift<Up>(freePawns) & ~occupied;
+        if (((singlePushes | (shift<Up>(singlePushes & ThirdRank) & ~occupied)) & checkMask) ||
+            ((shift<UpWest>(freePawns) | shift<UpEast>(freePawns)) & enemyPieces & checkMask))
+            return true;
+        uint64_t pinnedPawns = pawns & pinned;
+        while (pinnedPawns)
+        {
+            int from = popLSB(pinnedPawns);
+            uint64_t fromBB = 1ULL << from;
+            uint64_t pushes = shift<Up>(fromBB) & ~occupied;
+            pushes |= shift<Up>(pushes & ThirdRank) & ~occupied;
+            if ((pushes | (getPawnAttacks<Us>(from) & enemyPieces)) & checkMask & lineTable[kingSquare][from])
+                return true;
+        }
+
+        // Everything else by piece, sliders read with the current occupancy
+        uint64_t others = ourPieces & ~pawns & ~(1ULL << kingSquare);
+        while (others)
+        {
+            int from = popLSB(others);
+            uint64_t moves;
+            switch (pos.pieceTypeOn(from))
+            {
+            case PieceType::KNIGHT:
+                moves = getKnightMoves(from);
+                break;
+            case PieceType::BISHOP:
+                moves = getBishopMoves(from, occupied);
+                break;
+            case PieceType::ROOK:
+                moves = getRookMoves(from, occupied);
+                break;
+            default:
+                moves = getQueenMoves(from, occupied);
+                break;
+            }
+            if ((pinned >> from) & 1)
+                moves &= lineTable[kingSquare][from];
+            if (moves & targets)
+                return true;
+        }
+
+        // En passant last, it is rare and needs the full line test. As in the generator, it only counts in
+        // check if it takes the checker or lands between it and the king
+        const int epSquare = pos.enPassantSquare;
+        if (epSquare != -1 && (checkMask & ((1ULL << epSquare) | (1ULL << (epSquare - Up)))))
+        {
+            uint64_t capturers = getPawnAttacks<Them>(epSquare) & pawns;
+            while (capturers)
+            {
+                PackedMove move(popLSB(capturers), epSquare, MoveFlag::EN_PASSANT);
+                if (isPseudoLegal<Us>(pos, move) && isLegal<Us>(pos, move))
+                    return true;
+            }
+        }
+        return false;
     }
 
-    bool isInCheck(const Position &pos, Color color)
+    bool isPseudoLegal(const Position &pos, Color color, PackedMove move)
+    {
+        return (color == Color::WHITE) ? isPseudoLegal<Color::WHITE>(pos, move) : isPseudoLegal<Color::BLACK>(pos, move);
+    }
+
+    bool isLegal(const Position &pos, Color color, PackedMove move)
     {
-        uint64_t kingBB = (color == Color::WHITE) ? pos.whiteKing : pos.blackKing;
-        int kingSquare = __builtin_ctzll(kingBB);
-        return isSquareAttacked(kingSquare, invertColor(color), pos);
+        if (color == Color::WHITE)
+            return isPseudoLegal<Color::WHITE>(pos, move) && isLegal<Color::WHITE>(pos, move);
+        return isPseudoLegal<Color::BLACK>(pos, move) && isLegal<Color::BLACK>(pos, move);
     }
 
-    bool wouldLeaveKingInCheck(const Position &pos, const Move &move)
+    bool hasAnyLegalMove(const Position &pos, Color color)
     {
-        const Position tempPos(pos, move);
-        return isInCheck(tempPos, move.color); // Check if the move leaves the king in check;
+        return (color == Color::WHITE) ? hasAnyLegalMove<Color::WHITE>(pos) : hasAnyLegalMove<Color::BLACK>(pos);
     }
 
     // 0 is safe, 1 is check, 2 is checkmate, 3 is stalemate
     int checkEndgameConditions(const Position &pos, Color color)
     {
-        std::vector<Move> nextMoves = generateMoves(pos, color);
+        bool hasMoves = hasAnyLegalMove(pos, color);
         bool isCheck = isInCheck(pos, color);
-        if (nextMoves.empty())
+        if (!hasMoves)
         {
             if (isCheck)
             {
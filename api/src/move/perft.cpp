@@ -0,0 +1,414 @@
+#include "move/perft.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <iomanip>
+#include <memory>
+#include "engine-related/threadPool.h"
+
+namespace coredump
+{
+    // Perft hash slot. As in the transposition table, the key word holds (key ^ nodes) so a torn
+    // write from another thread fails verification instead of returning a wrong count
+    struct PerftSlot
+    {
+        std::atomic<uint64_t> key;
+        std::atomic<uint64_t> nodes;
+    };
+
+    // Always-replace table of subtree counts, private to one perft call
+    class PerftHash
+    {
+    public:
+        explicit PerftHash(size_t megabytes)
+        {
+            size_t bytes = std::max<size_t>(megabytes, 1) * 1024 * 1024;
+            size_t count = 1;
+            while (count * 2 * sizeof(PerftSlot) <= bytes)
+                count *= 2;
+            slots.reset(new PerftSlot[count]);
+            mask = count - 1;
+            for (size_t i = 0; i < count; i++)
+            {
+                slots[i].key.store(0, std::memory_order_relaxed);
+                slots[i].nodes.store(0, std::memory_order_relaxed);
+            }
+        }
+
+        bool probe(uint64_t hash, int depth, uint64_t &nodes) const
+        {
+            uint64_t key = keyFor(hash, depth);
+            const PerftSlot &slot = slots[key & mask];
+            uint64_t stored = slot.nodes.load(std::memory_order_relaxed);
+            if ((slot.key.load(std::memory_order_relaxed) ^ stored) != key || stored == 0)
+                return false;
+            nodes = stored;
+            return true;
+        }
+
+        void store(uint64_t hash, int depth, uint64_t nodes)
+        {
+            uint64_t key = keyFor(hash, depth);
+            PerftSlot &slot = slots[key & mask];
+            slot.key.store(key ^ nodes, std::memory_order_relaxed);
+            slot.nodes.store(nodes, std::memory_order_relaxed);
+        }
+
+    private:
+        std::unique_ptr<PerftSlot[]> slots;
+        size_t mask = 0;
+
+        // Counts differ by depth, so the depth is folded into the key
+        static uint64_t keyFor(uint64_t hash, int depth)
+        {
+            return hash ^ (static_cast<uint64_t>(depth) * 0x9E3779B97F4A7C15ULL);
+        }
+    };
+
+    static uint64_t perftRecursive(Position &pos, int depth, PerftHash *table)
+    {
+        uint64_t nodes = 0;
+        if (table && depth > 1 && table->probe(pos.hash, depth, nodes))
+            return nodes;
+
+        MoveList moves = generateMoves(pos, pos.sideToMove);
+        if (depth == 1)
+            return moves.size(); // Bulk counting: legal moves are exactly the leaves
+
+        for (PackedMove move : moves)
+        {
+            StateInfo state;
+            pos.makeMove(move, state);
+            nodes += perftRecursive(pos, depth - 1, table);
+            pos.undoMove(move, state);
+        }
+
+        if (table)
+            table->store(pos.hash, depth, nodes);
+        return nodes;
+    }
+
+    std::vector<DivideEntry> divide(const Position &pos, int depth, size_t hashMegabytes, bool parallel)
+    {
+        std::vector<DivideEntry> entries;
+        if (depth < 1)
+            return entries;
+
+        MoveList rootMoves = generateMoves(pos, pos.sideToMove);
+        std::unique_ptr<PerftHash> table;
+        if (hashMegabytes > 0 && depth > 2)
+            table = std::make_unique<PerftHash>(hashMegabytes);
+
+        auto countMove = [&pos, depth, &table](PackedMove move)
+        {
+            if (depth == 1)
+                return static_cast<uint64_t>(1);
+            Position child(pos);
+            StateInfo state;
+            child.makeMove(move, state);
+            return perftRecursive(child, depth - 1, table.get());
+        };
+
+        if (parallel)
+        {
+            ThreadPool &pool = getThreadPool();
+            std::vector<std::future<uint64_t>> counts;
+            for (PackedMove move : rootMoves)
+                counts.push_back(pool.submit([&countMove, move]()
+                                             { return countMove(move); }));
+            for (size_t i = 0; i < rootMoves.size(); i++)
+                entries.push_back({moveToString(rootMoves[i]), pool.wait(counts[i])});
+        }
+        else
+        {
+            for (PackedMove move : rootMoves)
+                entries.push_back({moveToString(move), countMove(move)});
+        }
+
+        return entries;
+    }
+
+    uint64_t perft(const Position &pos, int depth, size_t hashMegabytes, bool parallel)
+    {
+        if (depth < 1)
+            return 1;
+
+        uint64_t nodes = 0;
+        for (const DivideEntry &entry : divide(pos, depth, hashMegabytes, parallel))
+            nodes += entry.nodes;
+        return nodes;
+    }
+
+    bool runPerftSuite(std::ostream &out, int maxDepth, size_t hashMegabytes, bool parallel)
+    {
+        bool allPassed = true;
+        uint64_t totalNodes = 0;
+        double totalSeconds = 0;
+
+        for (const PerftPosition &test : PERFT_POSITIONS)
+        {
+            int depth = test.suiteDepth;
+            if (maxDepth > 0)
+            {
+                depth = std::min<int>(maxDepth, static_cast<int>(test.expected.size()));
+                while (depth > 1 && test.expected[depth - 1] == 0)
+                    depth--;
+            }
+            uint64_t expected = test.expected[depth - 1];
+
+            Position pos(test.fen);
+            auto start = std::chrono::steady_clock::now();
+            uint64_t nodes = perft(pos, depth, hashMegabytes, parallel);
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            bool passed = (nodes == expected);
+            allPassed = allPassed && passed;
+            totalNodes += nodes;
+            totalSeconds += seconds;
+
+            out << (passed ? "PASS " : "FAIL ") << std::left << std::setw(15) << test.name
+                << " depth " << depth
+                << "  nodes " << std::setw(12) << nodes
+                << " expected " << std::setw(12) << expected
+                << std::fixed << std::setprecision(3) << " time " << seconds << "s"
+                << std::setprecision(0) << "  nps " << (seconds > 0 ? nodes / seconds : 0) << "\n";
+        }
+
+        out << (allPassed ? "All perft counts match" : "PERFT MISMATCH")
+            << std::fixed << std::setprecision(0) << " | total nodes " << totalNodes
+            << " | nps " << (totalSeconds > 0 ? totalNodes / totalSeconds : 0) << "\n";
+        return allPassed;
+    }
+
+    static volatile uint64_t benchmarkSink;
+
+    bool runUpdateBenchmark(std::ostream &out, int rounds)
+    {
+        std::vector<std::pair<Position, MoveList>> samples;
+        visitReferencePositions(2, [&](const Position &pos)
+                                { samples.emplace_back(pos, generateMoves(pos, pos.sideToMove)); });
+        uint64_t updates = 0;
+        for (const auto &sample : samples)
+            updates += sample.second.size();
+
+        // Exactness first, outside the timed loops
+        bool exact = true;
+        for (auto &sample : samples)
+        {
+            Position pos(sample.first);
+            for (PackedMove move : sample.second)
+            {
+                StateInfo state;
+                pos.makeMove(move, state);
+                exact = exact && pos.hash == pos.computeHash() && pos.scores == pos.computeScores();
+                pos.undoMove(move, state);
+                exact = exact && pos == sample.first;
+            }
+        }
+
+        // A checksum of the keys, stored to a volatile, keeps the compiler from dropping the updates
+        uint64_t checksum = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int round = 0; round < rounds; round++)
+        {
+            for (auto &sample : samples)
+            {
+                Position &pos = sample.first;
+                for (PackedMove move : sample.second)
+                {
+                    StateInfo state;
+                    pos.makeMove(move, state);
+                    checksum += pos.hash;
+                    pos.undoMove(move, state);
+                }
+            }
+        }
+        double makeUnmakeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        for (int round = 0; round < rounds; round++)
+        {
+            for (const auto &sample : samples)
+            {
+                for (PackedMove move : sample.second)
+                {
+                    Position child(sample.first);
+                    StateInfo state;
+                    child.makeMove(move, state);
+                    checksum -= child.hash;
+                }
+            }
+        }
+        double copyMakeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        const double total = static_cast<double>(updates) * rounds;
+        out << "Positions " << samples.size() << " | updates " << updates << " x " << rounds << " rounds\n"
+            << std::fixed << std::setprecision(2)
+            << "make/unmake " << makeUnmakeSeconds * 1e9 / total << " ns/move\n"
+            << "copy-make   " << copyMakeSeconds * 1e9 / total << " ns/move (" << sizeof(Position) << " byte position)\n"
+            << (exact ? "Every undo was exact" : "UNDO MISMATCH") << "\n";
+        benchmarkSink = checksum;
+        return exact;
+    }
+
+    // Move values in ascending order, so two lists compare as sets
+    static std::vector<uint16_t> sortedMoves(const MoveList &moves)
+    {
+        std::vector<uint16_t> values;
+        for (PackedMove move : moves)
+            values.push_back(move.data);
+        std::sort(values.begin(), values.end());
+        return values;
+    }
+
+    // Whether the cached checkers and pins of color match a recount from attackersTo: a piece is pinned if
+    // taking it off the board lets an enemy slider onto the king
+    static bool attackInfoMatches(const Position &pos, Color color)
+    {
+        const Color them = invertColor(color);
+        const int kingSquare = pos.kingSquare(color);
+        const uint64_t occupied = pos.getOccupiedSquares();
+        const uint64_t enemySliders = pos.pieces(them, PieceType::BISHOP, PieceType::QUEEN) | pos.pieces(them, PieceType::ROOK, PieceType::QUEEN);
+        const uint64_t attackers = attackersTo(kingSquare, occupied, pos) & pos.pieces(them);
+
+        uint64_t pinned = 0;
+        uint64_t candidates = pos.pieces(color) & ~(1ULL << kingSquare);
+        while (candidates)
+        {
+            const int square = popLSB(candidates);
+            if (attackersTo(kingSquare, occupied ^ (1ULL << square), pos) & enemySliders & ~attackers)
+                pinned |= 1ULL << square;
+        }
+        return checkers(pos, color) == attackers && pinnedPieces(pos, color) == pinned;
+    }
+
+    // Positions the reference set never reaches, each a case the generator and isLegal once disagreed on
+    static const char *const MOVEGEN_EDGE_CASES[] = {
+        "4k3/8/5n2/3pP3/4K3/8/8/8 w - d6 0 1", // En passant available while in check from a piece it doesn't resolve
+    };
+
+    bool runMoveGenCheck(std::ostream &out, int depth)
+    {
+        uint64_t positions = 0, moves = 0, splitErrors = 0, evasionErrors = 0, quietCheckErrors = 0, givesCheckErrors = 0, attackInfoErrors = 0, validationErrors = 0, anyMoveErrors = 0;
+        auto check = [&](const Position &pos)
+        {
+            const Color us = pos.sideToMove;
+            const MoveList legal = generateMoves(pos, us);
+            const std::vector<uint16_t> all = sortedMoves(legal);
+            positions++;
+            moves += all.size();
+
+            MoveList split = generateMoves(pos, us, GenType::CAPTURES);
+            for (PackedMove move : generateMoves(pos, us, GenType::QUIETS))
+                split.push_back(move);
+            if (sortedMoves(split) != all) // Equal sizes too, so nothing is in both halves
+                splitErrors++;
+
+            if (isInCheck(pos, us) && sortedMoves(generateMoves(pos, us, GenType::EVASIONS)) != all)
+                evasionErrors++;
+
+            MoveList quietChecks;
+            for (PackedMove move : generateMoves(pos, us, GenType::QUIETS))
+            {
+                Position child(pos);
+                StateInfo state;
+                child.makeMove(move, state);
+                if (!move.isCastling() && isInCheck(child, invertColor(us)))
+                    quietChecks.push_back(move);
+            }
+            if (sortedMoves(generateMoves(pos, us, GenType::QUIET_CHECKS)) != sortedMoves(quietChecks))
+                quietCheckErrors++;
+
+            for (PackedMove move : legal)
+            {
+                Position child(pos);
+                StateInfo state;
+                child.makeMove(move, state);
+                if (givesCheck(pos, move) != isInCheck(child, invertColor(us)))
+                    givesCheckErrors++;
+            }
+
+            if (!attackInfoMatches(pos, Color::WHITE) || !attackInfoMatches(pos, Color::BLACK))
+                attackInfoErrors++;
+
+            // Every 16 bit value, as a TT hash collision could produce
+            std::vector<bool> generated(1 << 16, false);
+            for (PackedMove move : legal)
+            {
+                generated[move.data] = true;
+                if (!isPseudoLegal(pos, us, move))
+                    validationErrors++;
+            }
+            for (uint32_t value = 0; value < (1 << 16); value++)
+            {
+                if (isLegal(pos, us, PackedMove(static_cast<uint16_t>(value))) != generated[value])
+                    validationErrors++;
+            }
+
+            if (hasAnyLegalMove(pos, us) == legal.empty())
+                anyMoveErrors++;
+        };
+        visitReferencePositions(depth, check);
+        for (const char *fen : MOVEGEN_EDGE_CASES)
+        {
+            Position pos(fen);
+            visitPositions(pos, 1, check);
+        }
+
+        const bool passed = !splitErrors && !evasionErrors && !quietCheckErrors && !givesCheckErrors && !attackInfoErrors && !validationErrors && !anyMoveErrors;
+        out << "Positions " << positions << " | moves " << moves << "\n"
+            << "CAPTURES + QUIETS != ALL        " << splitErrors << "\n"
+            << "EVASIONS != ALL in check        " << evasionErrors << "\n"
+            << "QUIET_CHECKS != checking QUIETS " << quietCheckErrors << "\n"
+            << "givesCheck != made move         " << givesCheckErrors << "\n"
+            << "checkers/pins != recount        " << attackInfoErrors << "\n"
+            << "isLegal != generated            " << validationErrors << "\n"
+            << "hasAnyLegalMove != generated    " << anyMoveErrors << "\n"
+            << (passed ? "Generator, attack info and validation agree" : "GENERATOR MISMATCH") << "\n";
+        return passed;
+    }
+
+    // Every blocker subset of one slider mask, enumerated carry-rippler style. Returns the number of wrong lookups
+    template <typename Lookup, typename Reference>
+    static uint64_t checkSliderSubsets(int square, uint64_t mask, Lookup lookup, Reference reference, uint64_t &noise, uint64_t &lookups)
+    {
+        uint64_t errors = 0;
+        uint64_t subset = 0;
+        do
+        {
+            // xorshift64: squares outside the mask must not change the answer
+            noise ^= noise << 13;
+            noise ^= noise >> 7;
+            noise ^= noise << 17;
+            if (lookup(square, subset | (noise & ~mask)) != reference(square, subset))
+                errors++;
+            lookups++;
+            subset = (subset - mask) & mask;
+        } while (subset);
+        return errors;
+    }
+
+    bool runSliderCheck(std::ostream &out)
+    {
+        uint64_t noise = 0x9E3779B97F4A7C15ULL, lookups = 0, rookErrors = 0, bishopErrors = 0;
+        for (int square = 0; square < 64; square++)
+        {
+            rookErrors += checkSliderSubsets(square, generateRookMask(square), getRookMoves, generateRookAttacks, noise, lookups);
+            bishopErrors += checkSliderSubsets(square, generateBishopMask(square), getBishopMoves, generateBishopAttacks, noise, lookups);
+        }
+
+        const bool passed = !rookErrors && !bishopErrors;
+#if defined(__BMI2__)
+        out << "Index PEXT";
+#else
+        out << "Index magic";
+#endif
+        out << " | occupancies " << lookups << "\n"
+            << "rook != ray walk   " << rookErrors << "\n"
+            << "bishop != ray walk " << bishopErrors << "\n"
+            << (passed ? "Every slider lookup agrees" : "SLIDER MISMATCH") << "\n";
+        return passed;
+    }
+}
@@ -0,0 +1,127 @@
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include "engine-related/engine.h"
+#include "move/perft.h"
+
+namespace cd = coredump;
+
+// Native perft / divide tool: movegen correctness gate and throughput benchmark
+// Exits non-zero if a reference count doesn't match
+static void printUsage()
+{
+    std::cout << "Usage:\n"
+              << "  core_dump_perft [suite [maxDepth]]       run the reference positions\n"
+              << "  core_dump_perft perft <depth> [fen]       count leaf nodes\n"
+              << "  core_dump_perft divide <depth> [fen]      count leaf nodes per root move\n"
+              << "  core_dump_perft updates [rounds]          make/unmake vs copy-make timing and undo check\n"
+              << "  core_dump_perft movegen [depth]           generator, attack info and isLegal checks (default depth 2)\n"
+              << "  core_dump_perft sliders                   check every rook and bishop table entry\n"
+              << "  core_dump_perft see [depth]               cross-check the two SEE forms (default depth 3)\n"
+              << "Options:\n"
+              << "  --hash <MB>      share a perft hash of this size (default off)\n"
+              << "  --threads <N>    thread pool size (default: hardware threads)\n"
+              << "  --serial         don't split root moves across threads\n";
+}
+
+int main(int argc, char **argv)
+{
+    std::string command = "suite";
+    int depth = 0;
+    std::string fen = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+    size_t hashMegabytes = 0;
+    int threads = 0;
+    bool parallel = true;
+
+    // Positional arguments: command, depth, then the FEN (which may arrive split on spaces)
+    std::string fenArgument;
+    int positional = 0;
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--hash") == 0 && i + 1 < argc)
+            hashMegabytes = std::strtoull(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            threads = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--serial") == 0)
+            parallel = false;
+        else if (std::strcmp(argv[i], "--help") == 0 || std::strcmp(argv[i], "-h") == 0)
+        {
+            printUsage();
+            return 0;
+        }
+        else if (positional == 0)
+        {
+            command = argv[i];
+            positional++;
+        }
+        else if (positional == 1)
+        {
+            depth = std::atoi(argv[i]);
+            positional++;
+        }
+        else
+        {
+            fenArgument += (fenArgument.empty() ? "" : " ") + std::string(argv[i]);
+        }
+    }
+    if (!fenArgument.empty())
+        fen = fenArgument;
+
+    cd::initEngine();
+    if (threads > 0)
+        cd::setThreadCount(threads);
+
+    if (command == "suite")
+        return cd::runPerftSuite(std::cout, depth, hashMegabytes, parallel) ? 0 : 1;
+
+    if (command == "updates")
+        return cd::runUpdateBenchmark(std::cout, depth > 0 ? depth : 20) ? 0 : 1;
+
+    if (command == "movegen")
+        return cd::runMoveGenCheck(std::cout, depth > 0 ? depth : 2) ? 0 : 1;
+
+    if (command == "sliders")
+        return cd::runSliderCheck(std::cout) ? 0 : 1;
+
+    if (command == "see")
+        return cd::runExchangeCheck(std::cout, depth > 0 ? depth : 3) ? 0 : 1;
+
+    if ((command != "perft" && command != "divide") || depth < 1)
+    {
+        printUsage();
+        return 2;
+    }
+
+    try
+    {
+        cd::Position pos(fen);
+        auto start = std::chrono::steady_clock::now();
+        uint64_t nodes = 0;
+        if (command == "divide")
+        {
+            for (const cd::DivideEntry &entry : cd::divide(pos, depth, hashMegabytes, parallel))
+            {
+                std::cout << entry.move << ": " << entry.nodes << "\n";
+                nodes += entry.nodes;
+            }
+            std::cout << "\n";
+        }
+        else
+        {
+            nodes = cd::perft(pos, depth, hashMegabytes, parallel);
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << "Nodes: " << nodes << "\n"
+                  << "Time: " << seconds << "s\n"
+                  << "NPS: " << static_cast<uint64_t>(seconds > 0 ? nodes / seconds : 0) << "\n";
+    }
+    catch (const std::invalid_argument &error)
+    {
+        std::cerr << error.what() << "\n";
+        return 2;
+    }
+    return 0;
+}
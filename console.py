@@ -29,14 +29,13 @@ def make_human_turn(current_position, current_player):
     # Create move to check legality
     move = Move(input_str, current_player)
 
-    legal_moves = cd.generate_moves(current_position, current_player)
-    legal_move = next((m for m in legal_moves if m.from_square == move.from_square and m.to_square == move.to_square), None)
+    legal_move = cd.validate_move(current_position, current_player, move)
 
     if legal_move is None:
         print("Illegal move.")
         return 1, None
 
-    move = legal_move  # Copy extra properties from legal move
+    move = legal_move  # Copy extra properties from the board
 
     # Handle pawn promotion
     if move.is_promotion:
@@ -170,8 +170,7 @@ class ChessBoard:
         return f"{Move.to_algebraic(move.from_square)} {Move.to_algebraic(move.to_square)}"
 
     def is_legal_move(self, move: Move):
-        legal_moves = cd.generate_moves(self.position, self.current_player)
-        legal_move = next((m for m in legal_moves if m.from_square == move.from_square and m.to_square == move.to_square), None)
+        legal_move = cd.validate_move(self.position, self.current_player, move)
         if legal_move is None:
             return False, None
         return True, legal_move